@@ -0,0 +1,123 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Read-mostly throughput of a callback that reader threads call in a loop
+// while one writer replaces it every 100 microseconds: through
+// boost::atomic_function, through a boost::function guarded by a mutex,
+// and through a shared_ptr to a boost::function accessed with the atomic
+// shared_ptr functions. Takes the number of reader threads as argument,
+// by default the number of hardware threads.
+
+#include <boost/function/atomic_function.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef boost::function<long(long)> function;
+
+struct add
+{
+  long operator()(long x) const { return value + x; }
+  long value;
+};
+
+struct with_atomic_function
+{
+  with_atomic_function() : f(add()) {}
+  long call(long x) { return f(x); }
+  void store(long v) { add a = { v }; f.store(a); }
+
+  boost::atomic_function<long(long)> f;
+};
+
+struct with_mutex
+{
+  with_mutex() : f(add()) {}
+
+  long call(long x)
+  {
+    std::lock_guard<std::mutex> lock(m);
+    return f(x);
+  }
+
+  void store(long v)
+  {
+    add a = { v };
+    function g(a);
+    std::lock_guard<std::mutex> lock(m);
+    f.swap(g);
+  }
+
+  std::mutex m;
+  function f;
+};
+
+struct with_shared_ptr
+{
+  with_shared_ptr() : f(std::make_shared<function>(add())) {}
+  long call(long x) { return (*std::atomic_load(&f))(x); }
+  void store(long v) { add a = { v }; std::atomic_store(&f, std::make_shared<function>(a)); }
+
+  std::shared_ptr<function> f;
+};
+
+template<typename Callback>
+void run(const char* name, int threads)
+{
+  Callback callback;
+  std::atomic<bool> done(false);
+  std::atomic<long> calls(0);
+  std::atomic<long> sum(0);
+
+  std::vector<std::thread> readers;
+  for (int t = 0; t < threads; ++t) {
+    readers.push_back(std::thread([&] {
+      long n = 0;
+      long s = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < 256; ++i)
+          s += callback.call(i);
+        n += 256;
+      }
+      calls += n;
+      sum += s;
+    }));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  auto stop = start + std::chrono::seconds(1);
+  long stores = 0;
+  while (std::chrono::steady_clock::now() < stop) {
+    callback.store(++stores);
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  done = true;
+  for (std::size_t t = 0; t < readers.size(); ++t)
+    readers[t].join();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::printf("%-16s %8.1f M calls/s, %7.2f ns/call per thread, %ld stores (%ld)\n",
+              name, calls / seconds / 1e6, seconds * threads * 1e9 / calls,
+              stores, sum.load());
+}
+
+int main(int argc, char* argv[])
+{
+  int threads = argc > 1 ? std::atoi(argv[1]) : int(std::thread::hardware_concurrency());
+  if (threads < 1)
+    threads = 1;
+  std::printf("%d reader threads\n", threads);
+
+  run<with_atomic_function>("atomic_function", threads);
+  run<with_mutex>("mutex", threads);
+  run<with_shared_ptr>("atomic shared_ptr", threads);
+}
@@ -0,0 +1,96 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Cost of calling each of 100k boost::function objects once, in random
+// order, when the caches have been flushed before every pass. The
+// targets are spread over 512 distinct function object types, so that
+// calls go through 512 distinct vtables. Built once as is and once with
+// BOOST_FUNCTION_CACHE_INVOKER defined, which keeps the invoker in the
+// function object and removes the load from the vtable.
+
+#include <boost/function.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+typedef boost::function<long(long)> function;
+
+template<int N>
+struct target
+{
+  long operator()(long x) const { return value + x * N; }
+  long value;
+};
+
+template<int N>
+struct factory
+{
+  static void fill(std::vector<function (*)(long)>& v)
+  {
+    factory<N - 1>::fill(v);
+    v.push_back(&make);
+  }
+
+  static function make(long value)
+  {
+    target<N> t = { value };
+    return function(t);
+  }
+};
+
+template<>
+struct factory<0>
+{
+  static void fill(std::vector<function (*)(long)>&) {}
+};
+
+int main()
+{
+  const int count = 100000;
+  const int passes = 20;
+
+  std::vector<function (*)(long)> makers;
+  factory<512>::fill(makers);
+
+  std::mt19937 random(42);
+  std::vector<function> functions;
+  functions.reserve(count);
+  for (int i = 0; i < count; ++i)
+    functions.push_back(makers[random() % makers.size()](i));
+
+  std::vector<int> order(count);
+  for (int i = 0; i < count; ++i)
+    order[i] = i;
+  std::shuffle(order.begin(), order.end(), random);
+
+  // Larger than the last level cache
+  std::vector<char> flush(64 << 20);
+
+  double total = 0;
+  long sum = 0;
+  for (int pass = 0; pass < passes; ++pass) {
+    for (std::size_t i = 0; i < flush.size(); i += 64)
+      flush[i] = static_cast<char>(flush[i] + 1);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i)
+      sum += functions[order[i]](i);
+    auto stop = std::chrono::steady_clock::now();
+    total += std::chrono::duration<double, std::nano>(stop - start).count();
+  }
+
+#ifdef BOOST_FUNCTION_CACHE_INVOKER
+  const char* layout = "cached invoker";
+#else
+  const char* layout = "vtable invoker";
+#endif
+  std::printf("%-15s %2u bytes: %6.2f ns/call, cold (%ld)\n",
+              layout, static_cast<unsigned>(sizeof(function)),
+              total / (double(count) * passes), sum);
+}
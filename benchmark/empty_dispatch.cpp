@@ -0,0 +1,75 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Latency of hot call sites that call boost::function objects, which
+// dispatch unconditionally since empty functions point at a throwing
+// vtable, against the same call sites testing for emptiness and throwing
+// bad_function_call first, as operator() used to. The code size of each
+// call site is printed by
+//   nm -C -S --size-sort empty_dispatch | grep call_site
+
+#include <boost/function.hpp>
+#include <chrono>
+#include <cstdio>
+
+typedef boost::function<long(long)> function;
+
+struct add
+{
+  long operator()(long x) const { return value + x; }
+  long value;
+};
+
+BOOST_NOINLINE long call_site_unconditional(const function* f, int n, long x)
+{
+  long sum = 0;
+  for (int i = 0; i < n; ++i)
+    sum += f[i](x) + f[i](x + 1);
+  return sum;
+}
+
+BOOST_NOINLINE long call_site_checked(const function* f, int n, long x)
+{
+  long sum = 0;
+  for (int i = 0; i < n; ++i) {
+    if (f[i].empty())
+      boost::throw_exception(boost::bad_function_call());
+    sum += f[i](x);
+    if (f[i].empty())
+      boost::throw_exception(boost::bad_function_call());
+    sum += f[i](x + 1);
+  }
+  return sum;
+}
+
+template<typename CallSite>
+void run(const char* name, CallSite call_site, const function* f, int n)
+{
+  const int rounds = 200000;
+
+  long sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    sum += call_site(f, n, r);
+  auto stop = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  std::printf("%-14s %6.2f ns/call (%ld)\n", name, ns / (2.0 * rounds * n), sum);
+}
+
+int main()
+{
+  const int n = 64;
+  function f[n];
+  for (int i = 0; i < n; ++i) {
+    add a = { i };
+    f[i] = a;
+  }
+
+  run("unconditional", &call_site_unconditional, f, n);
+  run("checked", &call_site_checked, f, n);
+}
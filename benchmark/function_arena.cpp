@@ -0,0 +1,108 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// 1M requests, each building 48 callbacks of 64 bytes, a copy of each,
+// calling them and destroying them all at the end of the request:
+//  - with operator new (glibc malloc),
+//  - with a function_arena over a 16 KB buffer, reset per request,
+// for trivially destructible callbacks and for callbacks holding a
+// shared_ptr.
+
+#include <boost/function.hpp>
+#include <boost/function/function_arena.hpp>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+typedef boost::function<long(long)> function;
+
+struct trivial_callback
+{
+  long operator()(long x) const { return x + data[0]; }
+  long data[8];
+};
+
+struct owning_callback
+{
+  long operator()(long x) const { return x + *state + data[0]; }
+  std::shared_ptr<long> state;
+  long data[6];
+};
+
+trivial_callback make_callback(long i, const std::shared_ptr<long>&)
+{
+  trivial_callback c = { { i } };
+  return c;
+}
+
+owning_callback make_owning_callback(long i, const std::shared_ptr<long>& state)
+{
+  owning_callback c = { state, { i } };
+  return c;
+}
+
+const long requests = 1000000;
+const int callbacks = 48;
+
+struct with_new
+{
+  explicit with_new(char*, std::size_t) {}
+
+  template<typename F>
+  function make(const F& f) { return function(f); }
+
+  void end_request() {}
+};
+
+struct with_arena
+{
+  with_arena(char* buffer, std::size_t size) : arena(buffer, size) {}
+
+  template<typename F>
+  function make(const F& f) { return function(f, &arena); }
+
+  void end_request() { arena.reset(); }
+
+  boost::function_arena arena;
+};
+
+template<typename Policy, typename Callback>
+double per_request(Callback (*make_callback)(long, const std::shared_ptr<long>&))
+{
+  static char buffer[16384];
+  Policy policy(buffer, sizeof(buffer));
+  std::shared_ptr<long> state(new long(1));
+  std::vector<function> functions;
+  functions.reserve(2 * callbacks);
+  long sum = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (long r = 0; r < requests; ++r) {
+    for (int i = 0; i < callbacks; ++i) {
+      functions.push_back(policy.make(make_callback(i, state)));
+      functions.push_back(functions.back());
+    }
+    for (std::size_t i = 0; i < functions.size(); ++i)
+      sum += functions[i](r);
+    functions.clear();
+    policy.end_request();
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  if (sum == 42)
+    std::printf("!");
+  return ns / requests;
+}
+
+int main()
+{
+  std::printf("trivial callbacks: %8.1f ns (new) %8.1f ns (arena) per request\n",
+              per_request<with_new>(make_callback), per_request<with_arena>(make_callback));
+  std::printf("owning callbacks:  %8.1f ns (new) %8.1f ns (arena) per request\n",
+              per_request<with_new>(make_owning_callback),
+              per_request<with_arena>(make_owning_callback));
+}
@@ -0,0 +1,187 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Throughput and latency of boost::function_executor on 1 to N threads,
+// N being the argument or the number of hardware threads, against a pool
+// sharing one mutex-protected queue of boost::function<void()>:
+//  - 2M tiny tasks submitted from outside the pool,
+//  - a binary tree of 2M tiny tasks, each submitting its two children,
+//  - the latency from submitting a task to its start, one task at a time.
+
+#include <boost/function/function_executor.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock clock_type;
+
+// A thread pool with one locked queue, for comparison
+class locked_pool
+{
+public:
+  explicit locked_pool(std::size_t threads) : pending(0), stopping(false)
+  {
+    for (std::size_t i = 0; i < threads; ++i)
+      workers.push_back(std::thread([this] { work(); }));
+  }
+
+  ~locked_pool()
+  {
+    wait();
+    {
+      std::lock_guard<std::mutex> lock(m);
+      stopping = true;
+    }
+    ready.notify_all();
+    for (std::size_t i = 0; i < workers.size(); ++i)
+      workers[i].join();
+  }
+
+  template<typename F>
+  void submit(const F& f)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      ++pending;
+      tasks.push_back(boost::function<void()>(f));
+    }
+    ready.notify_one();
+  }
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(m);
+    while (pending != 0)
+      done.wait(lock);
+  }
+
+private:
+  void work()
+  {
+    std::unique_lock<std::mutex> lock(m);
+    for (;;) {
+      while (tasks.empty() && !stopping)
+        ready.wait(lock);
+      if (tasks.empty())
+        return;
+      boost::function<void()> task;
+      task.swap(tasks.front());
+      tasks.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+      if (--pending == 0)
+        done.notify_all();
+    }
+  }
+
+  std::mutex m;
+  std::condition_variable ready;
+  std::condition_variable done;
+  std::deque<boost::function<void()> > tasks;
+  std::vector<std::thread> workers;
+  std::size_t pending;
+  bool stopping;
+};
+
+static std::atomic<long> total(0);
+
+// 32 bytes of captures: more than the buffer of boost::function
+struct tiny
+{
+  void operator()() const { total.fetch_add(a + b + c + d, std::memory_order_relaxed); }
+  long a, b, c, d;
+};
+
+template<typename Pool>
+struct tree
+{
+  void operator()() const
+  {
+    if (depth == 0) {
+      total.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      tree child = { pool, depth - 1 };
+      pool->submit(child);
+      pool->submit(child);
+    }
+  }
+
+  Pool* pool;
+  int depth;
+};
+
+struct stamp
+{
+  void operator()() const
+  {
+    *latency = std::chrono::duration<double, std::nano>(clock_type::now() - submitted).count();
+    started->store(true, std::memory_order_release);
+  }
+
+  clock_type::time_point submitted;
+  double* latency;
+  std::atomic<bool>* started;
+};
+
+template<typename Pool>
+void run(const char* name, std::size_t threads)
+{
+  Pool pool(threads);
+
+  const long count = 2000000;
+  auto start = clock_type::now();
+  for (long i = 0; i < count; ++i) {
+    tiny t = { i, 1, 2, 3 };
+    pool.submit(t);
+  }
+  pool.wait();
+  double external = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+
+  start = clock_type::now();
+  tree<Pool> root = { &pool, 20 };
+  pool.submit(root);
+  pool.wait();
+  double spawned = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+
+  std::vector<double> latencies(2000);
+  for (std::size_t i = 0; i < latencies.size(); ++i) {
+    std::atomic<bool> started(false);
+    stamp s = { clock_type::now(), &latencies[i], &started };
+    pool.submit(s);
+    while (!started.load(std::memory_order_acquire))
+      std::this_thread::yield();
+    pool.wait();
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  std::printf("%-17s %2u threads: %6.1f ns/task external, %6.1f ns/task spawned, "
+              "latency %7.0f ns median %8.0f ns p99\n",
+              name, static_cast<unsigned>(threads), external / count,
+              spawned / ((2 << 20) - 1), latencies[latencies.size() / 2],
+              latencies[latencies.size() * 99 / 100]);
+}
+
+int main(int argc, char* argv[])
+{
+  std::size_t n = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+  if (n < 1)
+    n = 1;
+
+  for (std::size_t threads = 1; threads <= n; threads *= 2) {
+    run<boost::function_executor>("function_executor", threads);
+    run<locked_pool>("locked queue", threads);
+  }
+  std::printf("(%ld)\n", total.load());
+}
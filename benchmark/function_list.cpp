@@ -0,0 +1,157 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Emission throughput of a list of 1, 10 and 1000 subscribers while a
+// second thread keeps connecting and disconnecting one more subscriber:
+// through boost::function_list, through a vector of boost::function
+// locked for the whole emission, and through the same vector copied
+// under the lock before each emission. Half of the subscribers hold
+// targets too large for the small-object buffer.
+
+#include <boost/function/function_list.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef boost::function<void(long)> function;
+
+struct add
+{
+  void operator()(long x) const { *sum += x + value; }
+  long* sum;
+  long value;
+};
+
+struct add_large
+{
+  void operator()(long x) const { *sum += x + values[0]; }
+  long* sum;
+  long values[16];
+};
+
+function subscriber(long* sum, long i)
+{
+  if (i % 2 == 0) {
+    add a = { sum, i };
+    return a;
+  } else {
+    add_large a = { sum, { i } };
+    return a;
+  }
+}
+
+struct with_function_list
+{
+  typedef boost::function_list<void(long)>::connection connection;
+
+  connection connect(const function& f) { return list.connect(f); }
+  void disconnect(connection c) { list.disconnect(c); }
+  void emit(long x) { list(x); }
+
+  boost::function_list<void(long)> list;
+};
+
+struct with_locked_vector
+{
+  typedef long connection;
+
+  connection connect(const function& f)
+  {
+    std::lock_guard<std::mutex> lock(m);
+    subscribers.push_back(std::make_pair(++next, f));
+    return next;
+  }
+
+  void disconnect(connection c)
+  {
+    std::lock_guard<std::mutex> lock(m);
+    for (std::size_t i = 0; i < subscribers.size(); ++i) {
+      if (subscribers[i].first == c) {
+        subscribers.erase(subscribers.begin() + i);
+        return;
+      }
+    }
+  }
+
+  void emit(long x)
+  {
+    std::lock_guard<std::mutex> lock(m);
+    for (std::size_t i = 0; i < subscribers.size(); ++i)
+      subscribers[i].second(x);
+  }
+
+  std::mutex m;
+  std::vector<std::pair<long, function> > subscribers;
+  long next = 0;
+};
+
+struct with_copied_vector : with_locked_vector
+{
+  void emit(long x)
+  {
+    std::vector<std::pair<long, function> > copy;
+    {
+      std::lock_guard<std::mutex> lock(m);
+      copy = subscribers;
+    }
+    for (std::size_t i = 0; i < copy.size(); ++i)
+      copy[i].second(x);
+  }
+};
+
+template<typename List>
+void run(const char* name, int subscribers)
+{
+  List list;
+  long sum = 0;
+  long churn_sum = 0;
+  for (int i = 0; i < subscribers; ++i)
+    list.connect(subscriber(&sum, i));
+
+  std::atomic<bool> done(false);
+  std::atomic<long> churns(0);
+  std::thread churn([&] {
+    long n = 0;
+    while (!done.load(std::memory_order_relaxed)) {
+      list.disconnect(list.connect(subscriber(&churn_sum, n)));
+      ++n;
+      std::this_thread::yield();
+    }
+    churns = n;
+  });
+
+  long emissions = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto stop = start + std::chrono::milliseconds(500);
+  while (std::chrono::steady_clock::now() < stop) {
+    for (int i = 0; i < 16; ++i)
+      list.emit(i);
+    emissions += 16;
+  }
+  auto end = std::chrono::steady_clock::now();
+  done = true;
+  churn.join();
+
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  std::printf("%-16s %4d subscribers: %9.1f ns/emission, %6.2f ns/call, %ld churns (%ld)\n",
+              name, subscribers, ns / emissions, ns / (double(emissions) * subscribers),
+              churns.load(), sum);
+}
+
+int main()
+{
+  const int counts[] = { 1, 10, 1000 };
+  for (int i = 0; i < 3; ++i) {
+    run<with_function_list>("function_list", counts[i]);
+    run<with_locked_vector>("locked vector", counts[i]);
+    run<with_copied_vector>("copied vector", counts[i]);
+  }
+}
@@ -0,0 +1,123 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Function objects of 40, 120 and 240 bytes, stored on the heap, with
+// operator new (glibc malloc) and with function_pool_allocator:
+//  - one thread constructing, copying and destroying 10M functions,
+//  - one thread constructing 5M functions that a second one destroys,
+//    passed in batches of 1000.
+
+#include <boost/function.hpp>
+#include <boost/function/function_pool_allocator.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+template<int Size>
+struct payload
+{
+  long operator()(long x) const { return x + data[0]; }
+  long data[Size / sizeof(long)];
+};
+
+typedef boost::function<long(long)> function;
+
+struct with_new
+{
+  template<typename F>
+  static function make(const F& f) { return function(f); }
+};
+
+struct with_pool
+{
+  template<typename F>
+  static function make(const F& f) { return function(f, boost::function_pool_allocator<int>()); }
+};
+
+template<typename Policy, int Size>
+double single_thread()
+{
+  const long count = 10000000;
+  payload<Size> p = { { 1 } };
+  long sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < count / 2; ++i) {
+    function f = Policy::make(p);
+    function g(f);
+    sum += g(i);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  if (sum == 42)
+    std::printf("!");
+  return ns / count;
+}
+
+template<typename Policy, int Size>
+double cross_thread()
+{
+  const long count = 5000000;
+  const std::size_t batch = 1000;
+  std::mutex m;
+  std::condition_variable ready;
+  std::vector<std::vector<function> > batches;
+  bool done = false;
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread consumer([&] {
+    for (;;) {
+      std::vector<function> b;
+      {
+        std::unique_lock<std::mutex> lock(m);
+        while (batches.empty() && !done)
+          ready.wait(lock);
+        if (batches.empty())
+          return;
+        b.swap(batches.back());
+        batches.pop_back();
+      }
+    }
+  });
+
+  payload<Size> p = { { 1 } };
+  std::vector<function> b;
+  for (long i = 0; i < count; ++i) {
+    b.push_back(Policy::make(p));
+    if (b.size() == batch) {
+      std::lock_guard<std::mutex> lock(m);
+      batches.push_back(std::vector<function>());
+      batches.back().swap(b);
+      ready.notify_one();
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(m);
+    done = true;
+  }
+  ready.notify_one();
+  consumer.join();
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return ns / count;
+}
+
+template<int Size>
+void run()
+{
+  std::printf("%3d bytes: single thread %6.1f ns (new) %6.1f ns (pool), "
+              "cross thread %6.1f ns (new) %6.1f ns (pool) per function\n",
+              Size, single_thread<with_new, Size>(), single_thread<with_pool, Size>(),
+              cross_thread<with_new, Size>(), cross_thread<with_pool, Size>());
+}
+
+int main()
+{
+  run<40>();
+  run<120>();
+  run<240>();
+}
@@ -0,0 +1,89 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Cost of passing a lambda to a callee that calls it synchronously,
+// through a boost::function const& parameter and through a
+// boost::function_ref parameter. The lambda captures 8 or 32 bytes, so
+// that boost::function stores it inline or on the heap respectively.
+
+#include <boost/function.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static long allocations = 0;
+
+void* operator new(std::size_t n)
+{
+  ++allocations;
+  if (void* p = std::malloc(n))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+#endif
+
+BOOST_NOINLINE long call_function(const boost::function<long(long)>& f, long x)
+{
+  return f(x);
+}
+
+BOOST_NOINLINE long call_function_ref(boost::function_ref<long(long)> f, long x)
+{
+  return f(x);
+}
+
+template<typename Call>
+void run(const char* name, const char* size, Call call)
+{
+  const int calls = 10000000;
+
+  long sum = 0;
+  allocations = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < calls; ++i)
+    sum += call(i);
+  auto stop = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  std::printf("%-18s %-6s target: %6.2f ns/call, %5.2f allocations/call (%ld)\n",
+              name, size, ns / calls, double(allocations) / calls, sum);
+}
+
+int main()
+{
+  long a = 1, b = 2, c = 3, d = 4;
+
+  run("function const&", "small", [&](long i) {
+    return call_function([a](long x) { return a + x; }, i);
+  });
+  run("function_ref", "small", [&](long i) {
+    return call_function_ref([a](long x) { return a + x; }, i);
+  });
+  run("function const&", "large", [&](long i) {
+    return call_function([a, b, c, d](long x) { return a + b + c + d + x; }, i);
+  });
+  run("function_ref", "large", [&](long i) {
+    return call_function_ref([a, b, c, d](long x) { return a + b + c + d + x; }, i);
+  });
+
+  // Calling an existing function: function_ref adds one indirection
+  boost::function<long(long)> f = [a](long x) { return a + x; };
+  run("function const&", "stored", [&](long i) { return call_function(f, i); });
+  run("function_ref", "stored", [&](long i) { return call_function_ref(f, i); });
+}
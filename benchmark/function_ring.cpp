@@ -0,0 +1,129 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Handoff of 2M functions from producers to consumers, 1 to 1 and 2 to 2,
+// through boost::function_ring and through a mutex-protected std::deque
+// of boost::function<void()>. Reports operations per second and the
+// median and p99 latency from pushing a function to its call. Each
+// function holds a time stamp and two pointers, 24 bytes, which is more
+// than the small-object buffer of boost::function.
+
+#include <boost/function/function_ring.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock clock_type;
+
+static thread_local std::vector<float>* samples = 0;
+
+struct message
+{
+  void operator()() const
+  {
+    samples->push_back(std::chrono::duration<float, std::nano>(clock_type::now() - pushed).count());
+    counter->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  clock_type::time_point pushed;
+  std::atomic<long>* counter;
+  void* unused;
+};
+
+struct with_function_ring
+{
+  bool push(const message& m) { return ring.try_push(m); }
+  bool call() { return ring.try_call(); }
+
+  boost::function_ring<void(), 1024, 32> ring;
+};
+
+struct with_locked_deque
+{
+  bool push(const message& m)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (queue.size() >= 1024)
+      return false;
+    queue.push_back(m);
+    return true;
+  }
+
+  bool call()
+  {
+    boost::function<void()> f;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (queue.empty())
+        return false;
+      f.swap(queue.front());
+      queue.pop_front();
+    }
+    f();
+    return true;
+  }
+
+  std::mutex mutex;
+  std::deque<boost::function<void()> > queue;
+};
+
+template<typename Queue>
+void run(const char* name, int threads)
+{
+  static Queue queue;
+  const long count = 2000000;
+  std::atomic<long> called(0);
+  std::mutex merge;
+  std::vector<float> latencies;
+  latencies.reserve(count);
+
+  auto start = clock_type::now();
+  std::vector<std::thread> workers;
+  for (int p = 0; p < threads; ++p) {
+    workers.push_back(std::thread([&] {
+      for (long i = 0; i < count / threads; ++i) {
+        message m = { clock_type::now(), &called, 0 };
+        while (!queue.push(m))
+          std::this_thread::yield();
+      }
+    }));
+  }
+  for (int c = 0; c < threads; ++c) {
+    workers.push_back(std::thread([&] {
+      std::vector<float> own;
+      own.reserve(count);
+      samples = &own;
+      while (called.load(std::memory_order_relaxed) < count) {
+        if (!queue.call())
+          std::this_thread::yield();
+      }
+      std::lock_guard<std::mutex> lock(merge);
+      latencies.insert(latencies.end(), own.begin(), own.end());
+    }));
+  }
+  for (std::size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+  double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  std::sort(latencies.begin(), latencies.end());
+  std::printf("%-18s %d to %d: %6.2f M ops/s, latency %8.0f ns median %9.0f ns p99\n",
+              name, threads, threads, count / seconds / 1e6,
+              latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]);
+}
+
+int main()
+{
+  for (int threads = 1; threads <= 2; ++threads) {
+    run<with_function_ring>("function_ring", threads);
+    run<with_locked_deque>("locked deque", threads);
+  }
+}
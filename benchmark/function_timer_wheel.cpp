@@ -0,0 +1,118 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Churn of 10M timeouts with 500k of them active, on a simulated clock
+// advancing one tick every 64 operations. Each operation cancels the
+// oldest of the active timeouts, if it has not expired yet, and replaces
+// it with a timeout due in 1 to 100000 ticks. Compares
+// boost::function_timer_wheel with a std::multimap of tick to
+// boost::function<void()>.
+
+#include <boost/function/function_timer_wheel.hpp>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+typedef boost::function_timer_wheel::tick_type tick_type;
+
+static long fired = 0;
+
+struct timeout
+{
+  void operator()() const
+  {
+    alive[index] = 0;
+    ++fired;
+  }
+
+  unsigned char* alive;
+  std::size_t index;
+};
+
+struct with_timer_wheel
+{
+  typedef boost::function_timer_wheel::timer handle;
+
+  with_timer_wheel(std::size_t n) { wheel.reserve(n); }
+
+  handle schedule(tick_type when, const timeout& t) { return wheel.schedule_at(when, t); }
+  void cancel(handle h, bool) { wheel.cancel(h); }
+  void advance_to(tick_type when) { wheel.advance_to(when); }
+
+  boost::function_timer_wheel wheel;
+};
+
+struct with_multimap
+{
+  typedef std::multimap<tick_type, boost::function<void()> >::iterator handle;
+
+  with_multimap(std::size_t) {}
+
+  handle schedule(tick_type when, const timeout& t)
+  {
+    return timers.insert(std::make_pair(when, boost::function<void()>(t)));
+  }
+
+  void cancel(handle h, bool alive)
+  {
+    if (alive)
+      timers.erase(h);
+  }
+
+  void advance_to(tick_type when)
+  {
+    while (!timers.empty() && timers.begin()->first <= when) {
+      boost::function<void()> f;
+      f.swap(timers.begin()->second);
+      timers.erase(timers.begin());
+      f();
+    }
+  }
+
+  std::multimap<tick_type, boost::function<void()> > timers;
+};
+
+template<typename Timers>
+void run(const char* name)
+{
+  const std::size_t active = 500000;
+  const long operations = 10000000;
+
+  Timers timers(active);
+  std::vector<typename Timers::handle> handles(active);
+  std::vector<unsigned char> alive(active, 0);
+  unsigned long long random = 88172645463325252ULL;
+  tick_type now = 0;
+  fired = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < operations; ++i) {
+    std::size_t index = i % active;
+    if (i >= static_cast<long>(active))
+      timers.cancel(handles[index], alive[index] != 0);
+
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    timeout t = { alive.data(), index };
+    alive[index] = 1;
+    handles[index] = timers.schedule(now + 1 + random % 100000, t);
+
+    if (i % 64 == 63)
+      timers.advance_to(++now);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  std::printf("%-20s %6.1f ns/operation, %ld expired\n", name, ns / operations, fired);
+}
+
+int main()
+{
+  run<with_timer_wheel>("function_timer_wheel");
+  run<with_multimap>("multimap");
+}
@@ -0,0 +1,81 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Allocation count and copy latency of boost::function against
+// boost::basic_function with a 64 byte buffer, for function objects
+// capturing 32, 48 and 64 bytes.
+
+#include <boost/function.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static long allocations = 0;
+
+void* operator new(std::size_t n)
+{
+  ++allocations;
+  if (void* p = std::malloc(n))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+#endif
+
+template<int Bytes>
+struct capture
+{
+  explicit capture(long v) { for (auto& x: values) x = v; }
+  long operator()(long x) const { return values[0] + x; }
+  long values[Bytes / sizeof(long)];
+};
+
+template<typename Function, int Bytes>
+void run(const char* name)
+{
+  const int copies = 1000000;
+
+  Function f = capture<Bytes>(1);
+  long sum = 0;
+
+  allocations = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < copies; ++i) {
+    Function g(f);
+    sum += g(i);
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  std::printf("%-22s %3d bytes: %8.2f ns/copy, %5.2f allocations/copy (%ld)\n",
+              name, Bytes, ns / copies, double(allocations) / copies, sum);
+}
+
+int main()
+{
+  typedef boost::function<long(long)> function;
+  typedef boost::basic_function<long(long), 64> function64;
+
+  run<function, 32>("function");
+  run<function, 48>("function");
+  run<function, 64>("function");
+
+  run<function64, 32>("basic_function<64>");
+  run<function64, 48>("basic_function<64>");
+  run<function64, 64>("basic_function<64>");
+}
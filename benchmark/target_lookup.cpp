@@ -0,0 +1,119 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Latency of target<>() and contains() on boost::function objects holding
+// one of 16 function object types, for lookups that find their target and
+// for lookups that miss, against comparing target_type() with the
+// type_info of the requested type, as target<>() used to. Built once as is
+// and once with BOOST_FUNCTION_UNIQUE_TYPE_IDENTITY defined, which makes
+// misses skip the type_info comparison as well.
+
+#include <boost/function.hpp>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+typedef boost::function<long(long)> function;
+
+template<int N>
+struct target
+{
+  long operator()(long x) const { return value + x * N; }
+  long value;
+};
+
+template<int N>
+bool operator==(const target<N>& x, const target<N>& y)
+{
+  return x.value == y.value;
+}
+
+template<int N>
+struct factory
+{
+  static void fill(std::vector<function>& v, long value)
+  {
+    factory<N - 1>::fill(v, value);
+    target<N> t = { value };
+    v.push_back(function(t));
+  }
+};
+
+template<>
+struct factory<0>
+{
+  static void fill(std::vector<function>&, long) {}
+};
+
+BOOST_NOINLINE long lookup_target(const std::vector<function>& f)
+{
+  long found = 0;
+  for (std::size_t i = 0; i < f.size(); ++i)
+    if (const target<1>* t = f[i].target<target<1> >())
+      found += t->value;
+  return found;
+}
+
+BOOST_NOINLINE long lookup_contains(const std::vector<function>& f)
+{
+  target<1> t = { 1 };
+  long found = 0;
+  for (std::size_t i = 0; i < f.size(); ++i)
+    found += f[i].contains(t);
+  return found;
+}
+
+BOOST_NOINLINE long lookup_type_info(const std::vector<function>& f)
+{
+  long found = 0;
+  for (std::size_t i = 0; i < f.size(); ++i)
+    found += f[i].target_type() == boost::typeindex::type_id<target<1> >();
+  return found;
+}
+
+template<typename Lookup>
+void run(const char* name, Lookup lookup, const std::vector<function>& f)
+{
+  const int rounds = 200000;
+
+  long found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    found += lookup(f);
+  auto stop = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  std::printf("%-10s %6.2f ns/lookup (%ld)\n", name, ns / (double(rounds) * f.size()), found);
+}
+
+int main()
+{
+#ifdef BOOST_FUNCTION_UNIQUE_TYPE_IDENTITY
+  std::printf("unique type identity\n");
+#else
+  std::printf("type_info fallback on misses\n");
+#endif
+
+  // Every lookup hits
+  std::vector<function> hits;
+  for (int i = 0; i < 16; ++i)
+    factory<1>::fill(hits, 1);
+
+  // One lookup in 16 hits
+  std::vector<function> mixed;
+  factory<16>::fill(mixed, 1);
+
+  std::printf("hits:\n");
+  run("target", &lookup_target, hits);
+  run("contains", &lookup_contains, hits);
+  run("type_info", &lookup_type_info, hits);
+
+  std::printf("1/16 hits:\n");
+  run("target", &lookup_target, mixed);
+  run("contains", &lookup_contains, mixed);
+  run("type_info", &lookup_type_info, mixed);
+}
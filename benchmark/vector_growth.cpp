@@ -0,0 +1,66 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// Time to grow a std::vector of 1M boost::function objects by push_back,
+// when the vector relocates its elements by copying (every heap target
+// is cloned) and by moving (noexcept, the target pointer is transferred).
+
+#include <boost/function.hpp>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+typedef boost::function<long(long)> function;
+
+// A function object too large for the small-object buffer
+struct large
+{
+  explicit large(long v) { for (auto& x: values) x = v; }
+  long operator()(long x) const { return values[0] + x; }
+  long values[8];
+};
+
+// A function object stored inline
+struct small
+{
+  long operator()(long x) const { return value + x; }
+  long value;
+};
+
+// Hides the move constructor, so that std::vector has to copy
+struct copy_only: function
+{
+  template<typename F> copy_only(F f): function(f) {}
+  copy_only(const copy_only& f): function(static_cast<const function&>(f)) {}
+};
+
+template<typename Function, typename Target>
+void run(const char* name, const char* target)
+{
+  const int count = 1000000;
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<Function> v;
+  for (int i = 0; i < count; ++i)
+    v.push_back(Function(Target{i}));
+  auto stop = std::chrono::steady_clock::now();
+
+  long sum = 0;
+  for (int i = 0; i < count; i += 1000)
+    sum += v[i](1);
+
+  double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+  std::printf("%-10s %-6s targets: %8.2f ms (%ld)\n", name, target, ms, sum);
+}
+
+int main()
+{
+  run<copy_only, large>("copy", "heap");
+  run<function, large>("move", "heap");
+  run<copy_only, small>("copy", "inline");
+  run<function, small>("move", "inline");
+}
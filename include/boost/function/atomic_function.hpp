@@ -0,0 +1,120 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#ifndef BOOST_FUNCTION_ATOMIC_FUNCTION_HPP
+#define BOOST_FUNCTION_ATOMIC_FUNCTION_HPP
+
+#include <boost/function.hpp>
+#include <boost/function/detail/epoch_domain.hpp>
+#include <boost/config.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) && \
+    !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <atomic>
+
+namespace boost {
+
+template<typename Signature> class atomic_function;
+
+/**
+ * A boost::function that threads may call while others replace its
+ * target. Calls are wait-free: they announce the calling thread as a
+ * reader and call the current target without locking. store() is
+ * lock-free: it publishes a new target and retires the old one, which
+ * is destroyed once no call can still be using it. Replaced targets
+ * are reclaimed by later store() calls and by calls returning, on any
+ * atomic_function, and by the destructor; their destructors may thus
+ * run in a calling thread, after the call.
+ *
+ * As with a boost::function shared between threads, concurrent calls
+ * must be safe for the target itself. Destroying an atomic_function
+ * destroys its current target at once, so it must not race with calls.
+ */
+template<typename R, typename... Args>
+class atomic_function<R(Args...)>
+{
+public:
+  typedef boost::function<R(Args...)> function_type;
+  typedef R result_type;
+
+  atomic_function() BOOST_NOEXCEPT : current(0) {}
+
+  atomic_function(function_type f) : current(make_node(static_cast<function_type&&>(f))) {}
+
+  ~atomic_function()
+  {
+    detail::function::epoch_domain::instance().reclaim();
+    delete current.load(std::memory_order_relaxed);
+  }
+
+  /** Replace the target, as seen by the calls that start afterwards. */
+  void store(function_type f)
+  {
+    node* n = make_node(static_cast<function_type&&>(f));
+    if (node* old = current.exchange(n, std::memory_order_seq_cst))
+      detail::function::epoch_domain::instance().retire(old);
+  }
+
+  /** A copy of the current target. */
+  function_type load() const
+  {
+    detail::function::epoch_domain::guard guard;
+    node* n = current.load(std::memory_order_seq_cst);
+    return n ? n->f : function_type();
+  }
+
+  void clear() { store(function_type()); }
+
+  bool empty() const BOOST_NOEXCEPT
+  {
+    return current.load(std::memory_order_acquire) == 0;
+  }
+
+  R operator()(Args... args) const
+  {
+    detail::function::epoch_domain::guard guard;
+    node* n = current.load(std::memory_order_seq_cst);
+    if (!n)
+      boost::throw_exception(bad_function_call());
+    return n->f(static_cast<Args&&>(args)...);
+  }
+
+private:
+  atomic_function(const atomic_function&);
+  atomic_function& operator=(const atomic_function&);
+
+  struct node : detail::function::epoch_domain::retired
+  {
+    explicit node(function_type&& target) : f(static_cast<function_type&&>(target))
+    {
+      destroy = &destroy_node;
+    }
+
+    function_type f;
+  };
+
+  static void destroy_node(detail::function::epoch_domain::retired* n)
+  {
+    delete static_cast<node*>(n);
+  }
+
+  static node* make_node(function_type&& f)
+  {
+    return f.empty() ? 0 : new node(static_cast<function_type&&>(f));
+  }
+
+  std::atomic<node*> current;
+};
+
+} // end namespace boost
+
+#endif
+
+#endif // BOOST_FUNCTION_ATOMIC_FUNCTION_HPP
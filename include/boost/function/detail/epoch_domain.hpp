@@ -0,0 +1,208 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#ifndef BOOST_FUNCTION_DETAIL_EPOCH_DOMAIN_HPP
+#define BOOST_FUNCTION_DETAIL_EPOCH_DOMAIN_HPP
+
+#include <boost/config.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <atomic>
+
+namespace boost {
+  namespace detail {
+    namespace function {
+      /**
+       * Epoch-based reclamation of the nodes that atomic_function and
+       * function_list replace. Readers announce the global epoch in a
+       * record of their thread for the duration of a call, which is
+       * wait-free.
+       * A replaced node is retired with the epoch current at the time,
+       * and destroyed once the epoch has advanced twice, which it only
+       * does when every reading thread has announced the current epoch.
+       * Retiring is lock-free, and whichever writer finds no other one
+       * reclaiming advances the epoch and destroys old nodes. Readers that
+       * find retired nodes pending do the same when their read ends, so
+       * that the nodes do not wait for the next write.
+       */
+      class epoch_domain
+      {
+      public:
+        struct retired
+        {
+          retired* next;
+          unsigned long long epoch;
+          void (*destroy)(retired* node);
+        };
+
+        // The reading state of one thread, reused after it exits
+        struct reader
+        {
+          reader(): epoch(0), in_use(true), nesting(0), next(0) {}
+
+          // The announced epoch, or 0 outside of reads
+          std::atomic<unsigned long long> epoch;
+          std::atomic<bool> in_use;
+          unsigned nesting;
+          reader* next;
+
+          // Keeps the records of different threads on separate cache lines
+          char padding[64];
+        };
+
+        // Marks the calling thread as reading for its lifetime
+        class guard
+        {
+        public:
+          guard(): r(this_thread_reader())
+          {
+            // Both the announcement and the load of the target that
+            // follows are sequentially consistent, so that a writer
+            // replacing the target sees the announcement
+            if (r->nesting++ == 0)
+              r->epoch.exchange(instance().epoch.load(std::memory_order_relaxed),
+                                std::memory_order_seq_cst);
+          }
+
+          ~guard()
+          {
+            if (--r->nesting == 0) {
+              r->epoch.store(0, std::memory_order_release);
+              epoch_domain& domain = instance();
+              if (domain.retired_nodes.load(std::memory_order_relaxed))
+                domain.reclaim();
+            }
+          }
+
+        private:
+          guard(const guard&);
+          guard& operator=(const guard&);
+
+          reader* r;
+        };
+
+        // Never destroyed, so that it outlives static atomic_functions
+        static epoch_domain& instance()
+        {
+          static epoch_domain* domain = new epoch_domain;
+          return *domain;
+        }
+
+        void retire(retired* node)
+        {
+          node->epoch = epoch.load(std::memory_order_seq_cst);
+          push(node, node);
+          reclaim();
+        }
+
+        // Advances the epoch if every reader has seen it, and destroys
+        // the nodes that no reader can still see
+        void reclaim()
+        {
+          if (reclaiming.exchange(true, std::memory_order_acquire))
+            return;
+
+          unsigned long long e = epoch.load(std::memory_order_seq_cst);
+          if (quiescent(e))
+            epoch.store(++e, std::memory_order_seq_cst);
+
+          retired* node = retired_nodes.exchange(0, std::memory_order_acquire);
+          retired* first = 0;
+          retired* last = 0;
+          while (node) {
+            retired* next = node->next;
+            if (node->epoch + 2 <= e)
+              node->destroy(node);
+            else {
+              node->next = first;
+              first = node;
+              if (!last)
+                last = node;
+            }
+            node = next;
+          }
+          if (first)
+            push(first, last);
+
+          reclaiming.store(false, std::memory_order_release);
+        }
+
+      private:
+        epoch_domain(): epoch(1), readers(0), retired_nodes(0), reclaiming(false) {}
+
+        static reader* this_thread_reader()
+        {
+          static thread_local reader* r = 0;
+          if (!r)
+            r = instance().acquire_reader();
+          return r;
+        }
+
+        // Releases the record of the thread when it exits
+        struct reader_owner
+        {
+          ~reader_owner() { if (r) r->in_use.store(false, std::memory_order_release); }
+          reader* r;
+        };
+
+        reader* acquire_reader()
+        {
+          reader* r = readers.load(std::memory_order_acquire);
+          for (; r; r = r->next) {
+            bool free = false;
+            if (!r->in_use.load(std::memory_order_relaxed) &&
+                r->in_use.compare_exchange_strong(free, true, std::memory_order_acquire))
+              break;
+          }
+
+          if (!r) {
+            r = new reader;
+            r->next = readers.load(std::memory_order_relaxed);
+            while (!readers.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                                  std::memory_order_relaxed))
+              ;
+          }
+
+          static thread_local reader_owner owner;
+          owner.r = r;
+          return r;
+        }
+
+        bool quiescent(unsigned long long e) const
+        {
+          for (reader* r = readers.load(std::memory_order_acquire); r; r = r->next) {
+            unsigned long long announced = r->epoch.load(std::memory_order_seq_cst);
+            if (announced != 0 && announced != e)
+              return false;
+          }
+          return true;
+        }
+
+        // Pushes the list from first to last on the retired nodes
+        void push(retired* first, retired* last)
+        {
+          last->next = retired_nodes.load(std::memory_order_relaxed);
+          while (!retired_nodes.compare_exchange_weak(last->next, first,
+                                                      std::memory_order_release,
+                                                      std::memory_order_relaxed))
+            ;
+        }
+
+        std::atomic<unsigned long long> epoch;
+        std::atomic<reader*> readers;
+        std::atomic<retired*> retired_nodes;
+        std::atomic<bool> reclaiming;
+      };
+    } // end namespace function
+  } // end namespace detail
+} // end namespace boost
+
+#endif
+
+#endif // BOOST_FUNCTION_DETAIL_EPOCH_DOMAIN_HPP
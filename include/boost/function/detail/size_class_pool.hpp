@@ -0,0 +1,238 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#ifndef BOOST_FUNCTION_DETAIL_SIZE_CLASS_POOL_HPP
+#define BOOST_FUNCTION_DETAIL_SIZE_CLASS_POOL_HPP
+
+#include <boost/config.hpp>
+#include <boost/type_traits/type_with_alignment.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace boost {
+  namespace detail {
+    namespace function {
+      /**
+       * Memory for function objects stored on the heap, from free lists
+       * of blocks of the same size class, kept by each thread. Sizes are
+       * rounded up to a multiple of 16 bytes, and sizes above 256 bytes
+       * go to operator new directly.
+       *
+       * Each block starts with a header naming the cache of the thread
+       * that allocated it. A block freed by that thread goes back to its
+       * free list, up to max_cached blocks per size class, beyond which
+       * it is deleted. A block freed by another thread is pushed on a
+       * lock-free list of the cache it belongs to, and the owner takes
+       * these blocks back in one exchange when its own free list of that
+       * size class runs out.
+       *
+       * The cache of a thread that exits is kept, with its blocks, for
+       * the next thread that starts allocating, so that blocks freed
+       * later still have a cache to return to. Threads allocating during
+       * their exit, after their cache has been released, get blocks
+       * without a cache, which are deleted when freed.
+       */
+      class size_class_pool
+      {
+      public:
+        BOOST_STATIC_CONSTANT(std::size_t, granularity = 16);
+        BOOST_STATIC_CONSTANT(std::size_t, classes = 16);
+        BOOST_STATIC_CONSTANT(std::size_t, max_cached = 256);
+
+        static bool pooled(std::size_t size) { return size <= granularity * classes; }
+
+        static void* allocate(std::size_t size)
+        {
+          if (!pooled(size))
+            return ::operator new(size);
+
+          std::size_t c = size_class(size);
+          cache* owner = this_thread_cache();
+          if (owner) {
+            block* b = owner->local[c];
+            if (!b)
+              b = owner->reclaim(c);
+            if (b) {
+              owner->local[c] = b->next;
+              --owner->count[c];
+              return payload(b);
+            }
+          }
+
+          block* b = static_cast<block*>(::operator new(sizeof(header) + (c + 1) * granularity));
+          b->owner = owner;
+          return payload(b);
+        }
+
+        static void deallocate(void* p, std::size_t size) BOOST_NOEXCEPT
+        {
+          if (!pooled(size)) {
+            ::operator delete(p);
+            return;
+          }
+
+          std::size_t c = size_class(size);
+          block* b = reinterpret_cast<block*>(static_cast<char*>(p) - sizeof(header));
+          cache* owner = b->owner;
+          if (!owner) {
+            ::operator delete(b);
+          } else if (owner == this_thread_cache()) {
+            if (owner->count[c] >= max_cached) {
+              ::operator delete(b);
+            } else {
+              b->next = owner->local[c];
+              owner->local[c] = b;
+              ++owner->count[c];
+            }
+          } else {
+            owner->push_remote(c, b);
+          }
+        }
+
+      private:
+        struct cache;
+
+        // Keeps the payload of a block aligned for any type
+        union header
+        {
+          cache* owner;
+          boost::detail::max_align align;
+        };
+
+        struct block
+        {
+          cache* owner;
+          block* next;
+        };
+
+        // The free lists of one thread, reused after it exits
+        struct cache
+        {
+          cache() : in_use(true), next(0)
+          {
+            for (std::size_t c = 0; c < classes; ++c) {
+              local[c] = 0;
+              count[c] = 0;
+              remote[c].store(0, std::memory_order_relaxed);
+            }
+          }
+
+          // Takes the blocks of size class c freed by other threads
+          block* reclaim(std::size_t c)
+          {
+            block* b = remote[c].exchange(0, std::memory_order_acquire);
+            local[c] = b;
+            for (; b; b = b->next)
+              ++count[c];
+            return local[c];
+          }
+
+          void push_remote(std::size_t c, block* b)
+          {
+            b->next = remote[c].load(std::memory_order_relaxed);
+            while (!remote[c].compare_exchange_weak(b->next, b, std::memory_order_release,
+                                                    std::memory_order_relaxed))
+              ;
+          }
+
+          // Owner only
+          block* local[classes];
+          std::size_t count[classes];
+
+          std::atomic<block*> remote[classes];
+          std::atomic<bool> in_use;
+          cache* next;
+        };
+
+        static std::size_t size_class(std::size_t size)
+        {
+          return size == 0 ? 0 : (size - 1) / granularity;
+        }
+
+        // A free block links to the next one after its owner, in the
+        // padding of the header or at the start of the payload
+        static void* payload(block* b)
+        {
+          return reinterpret_cast<char*>(b) + sizeof(header);
+        }
+
+        // Never destroyed, as blocks may be freed during static destruction
+        static std::atomic<cache*>& caches()
+        {
+          static std::atomic<cache*>* list = new std::atomic<cache*>(0);
+          return *list;
+        }
+
+        // Releases the cache of the thread when it exits
+        struct cache_owner
+        {
+          ~cache_owner()
+          {
+            exited() = true;
+            current() = 0;
+            if (c)
+              c->in_use.store(false, std::memory_order_release);
+          }
+          cache* c;
+        };
+
+        static cache*& current()
+        {
+          static thread_local cache* c = 0;
+          return c;
+        }
+
+        static bool& exited()
+        {
+          static thread_local bool e = false;
+          return e;
+        }
+
+        static cache* this_thread_cache()
+        {
+          cache*& c = current();
+          if (!c && !exited())
+            c = acquire_cache();
+          return c;
+        }
+
+        static cache* acquire_cache()
+        {
+          std::atomic<cache*>& list = caches();
+          cache* c = list.load(std::memory_order_acquire);
+          for (; c; c = c->next) {
+            bool free = false;
+            if (!c->in_use.load(std::memory_order_relaxed) &&
+                c->in_use.compare_exchange_strong(free, true, std::memory_order_acquire))
+              break;
+          }
+
+          if (!c) {
+            c = new cache;
+            c->next = list.load(std::memory_order_relaxed);
+            while (!list.compare_exchange_weak(c->next, c, std::memory_order_release,
+                                               std::memory_order_relaxed))
+              ;
+          }
+
+          static thread_local cache_owner owner;
+          owner.c = c;
+          return c;
+        }
+      };
+    } // end namespace function
+  } // end namespace detail
+} // end namespace boost
+
+#endif
+
+#endif // BOOST_FUNCTION_DETAIL_SIZE_CLASS_POOL_HPP
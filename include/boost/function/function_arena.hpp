@@ -0,0 +1,226 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#ifndef BOOST_FUNCTION_FUNCTION_ARENA_HPP
+#define BOOST_FUNCTION_FUNCTION_ARENA_HPP
+
+#include <boost/function/function_base.hpp>
+#include <boost/config.hpp>
+#include <boost/core/noncopyable.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/type_with_alignment.hpp>
+#include <cstddef>
+#include <new>
+
+namespace boost {
+
+/**
+ * Memory for the function objects of functions that die together, such
+ * as the callbacks built while serving one request. Allocations bump a
+ * pointer through a buffer given by the caller, then through chunks of
+ * chunk_size bytes or more taken from operator new; reset() makes all
+ * of it available again at once, keeping the chunks for the next round.
+ *
+ * Functions given the arena as their allocator:
+ *
+ *   boost::function_arena arena(buffer, sizeof(buffer));
+ *   boost::function<void()> f(callback, &arena);
+ *
+ * allocate their function object from it when it does not fit in the
+ * small-object buffer, and so do their copies. Destroying or clearing
+ * them runs the destructor of the function object, or nothing at all
+ * when the function object is trivially destructible. Such functions
+ * must be destroyed or cleared before the arena is reset or destroyed.
+ *
+ * An arena is not thread-safe.
+ */
+class function_arena : noncopyable
+{
+public:
+  BOOST_STATIC_CONSTANT(std::size_t, default_chunk_size = 4096);
+
+  explicit function_arena(std::size_t chunk_size = default_chunk_size)
+    : initial(0), initial_size(0), chunks(0), active(0), position(0), limit(0),
+      min_chunk_size(chunk_size)
+  {
+  }
+
+  function_arena(void* buffer, std::size_t size,
+                 std::size_t chunk_size = default_chunk_size)
+    : initial(static_cast<char*>(buffer)), initial_size(size), chunks(0), active(0),
+      position(initial), limit(initial + size), min_chunk_size(chunk_size)
+  {
+  }
+
+  ~function_arena() { release(); }
+
+  // Returns size bytes aligned to alignment, a power of two
+  void* allocate(std::size_t size, std::size_t alignment)
+  {
+    std::size_t misalignment = reinterpret_cast<std::size_t>(position) & (alignment - 1);
+    std::size_t padding = misalignment ? alignment - misalignment : 0;
+    if (position && padding + size <= static_cast<std::size_t>(limit - position)) {
+      void* p = position + padding;
+      position += padding + size;
+      return p;
+    }
+    return allocate_from_next_chunk(size, alignment);
+  }
+
+  // Makes all the memory allocated from the arena available again
+  void reset() BOOST_NOEXCEPT
+  {
+    active = 0;
+    if (initial) {
+      position = initial;
+      limit = initial + initial_size;
+    } else {
+      position = limit = 0;
+    }
+  }
+
+  // Resets the arena and returns its chunks to operator delete
+  void release() BOOST_NOEXCEPT
+  {
+    while (chunks) {
+      chunk* next = chunks->next;
+      ::operator delete(chunks);
+      chunks = next;
+    }
+    reset();
+  }
+
+private:
+  struct chunk
+  {
+    chunk* next;
+    std::size_t size;
+  };
+
+  // Keeps the memory after the chunk aligned for any type
+  union chunk_header
+  {
+    chunk members;
+    boost::detail::max_align align;
+  };
+
+  static char* begin(chunk* c)
+  {
+    return reinterpret_cast<char*>(c) + sizeof(chunk_header);
+  }
+
+  // Moves to the chunk after the active one, when it is large enough,
+  // or to a new chunk inserted after it
+  void* allocate_from_next_chunk(std::size_t size, std::size_t alignment)
+  {
+    std::size_t needed =
+      size + (alignment > alignment_of<boost::detail::max_align>::value ? alignment : 0);
+    chunk* next = active ? active->next : chunks;
+    if (!next || next->size < needed) {
+      std::size_t bytes = needed > min_chunk_size ? needed : min_chunk_size;
+      chunk* c = static_cast<chunk*>(::operator new(sizeof(chunk_header) + bytes));
+      c->size = bytes;
+      c->next = next;
+      if (active)
+        active->next = c;
+      else
+        chunks = c;
+      next = c;
+    }
+
+    active = next;
+    position = begin(next);
+    limit = position + next->size;
+    return allocate(size, alignment);
+  }
+
+  char* initial;
+  std::size_t initial_size;
+  chunk* chunks;
+  chunk* active;
+  char* position;
+  char* limit;
+  std::size_t min_chunk_size;
+};
+
+/**
+ * An allocator drawing from a function_arena, whose deallocate() does
+ * nothing. Functions also accept a pointer to the arena itself, which
+ * they turn into this allocator.
+ */
+template<typename T>
+class function_arena_allocator
+{
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template<typename U>
+  struct rebind
+  {
+    typedef function_arena_allocator<U> other;
+  };
+
+  explicit function_arena_allocator(function_arena* arena) BOOST_NOEXCEPT : arena_(arena) {}
+
+  template<typename U>
+  function_arena_allocator(const function_arena_allocator<U>& other) BOOST_NOEXCEPT
+    : arena_(other.arena())
+  {
+  }
+
+  function_arena* arena() const BOOST_NOEXCEPT { return arena_; }
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignment_of<T>::value));
+  }
+
+  void deallocate(T*, std::size_t) BOOST_NOEXCEPT {}
+
+  void construct(T* p, const T& value) { new (p) T(value); }
+  void destroy(T* p) { p->~T(); }
+
+private:
+  function_arena* arena_;
+};
+
+template<typename T, typename U>
+inline bool operator==(const function_arena_allocator<T>& a, const function_arena_allocator<U>& b)
+{
+  return a.arena() == b.arena();
+}
+
+template<typename T, typename U>
+inline bool operator!=(const function_arena_allocator<T>& a, const function_arena_allocator<U>& b)
+{
+  return a.arena() != b.arena();
+}
+
+namespace detail {
+  namespace function {
+    template<typename T>
+    struct allocator_reclaims_in_bulk<function_arena_allocator<T> > : true_type {};
+
+    template<>
+    struct function_allocator<function_arena*, false>
+    {
+      typedef function_arena_allocator<char> type;
+      static type get(function_arena* arena) { return type(arena); }
+    };
+  } // end namespace function
+} // end namespace detail
+
+} // end namespace boost
+
+#endif // BOOST_FUNCTION_FUNCTION_ARENA_HPP
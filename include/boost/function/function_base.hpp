@@ -12,6 +12,7 @@
 #define BOOST_FUNCTION_BASE_HEADER
 
 #include <stdexcept>
+#include <cstring>
 #include <string>
 #include <memory>
 #include <new>
@@ -24,11 +25,22 @@
 #include <boost/type_traits/is_const.hpp>
 #include <boost/type_traits/is_integral.hpp>
 #include <boost/type_traits/is_volatile.hpp>
+#include <boost/type_traits/is_void.hpp>
+#include <boost/type_traits/remove_cv.hpp>
 #include <boost/type_traits/composite_traits.hpp>
 #include <boost/ref.hpp>
 #include <boost/type_traits/conditional.hpp>
 #include <boost/config/workaround.hpp>
 #include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/type_with_alignment.hpp>
+#include <boost/type_traits/decay.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+#include <boost/type_traits/is_nothrow_move_constructible.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/align/aligned_alloc.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/core/no_exceptions_support.hpp>
 #ifndef BOOST_NO_SFINAE
 #include <boost/type_traits/enable_if.hpp>
 #else
@@ -54,11 +66,109 @@
                            !(::boost::is_integral<Functor>::value), \
                            Type>::type
 
+// Pass function objects down to their final storage without copying.
+// These stay defined, as each inclusion of function_template.hpp uses
+// them.
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   define BOOST_FUNCTION_FWD_REF(T) const T&
+#   define BOOST_FUNCTION_FORWARD(T,x) x
+#else
+#   define BOOST_FUNCTION_FWD_REF(T) T&&
+#   define BOOST_FUNCTION_FORWARD(T,x) static_cast<T&&>(x)
+#endif
+
+// When BOOST_FUNCTION_CACHE_INVOKER is defined, every function object
+// keeps a copy of its invoker pointer next to its buffer, so that a call
+// does not have to load it from the vtable first. Functions become one
+// pointer larger. As this changes the layout of the function classes, it
+// must be defined identically in every translation unit of a program.
+
+// target() and contains() identify types by the address of a per-type
+// static object, which needs no RTTI, and compare type_info objects (or
+// their emulation under BOOST_NO_RTTI) only when the addresses differ.
+// Define BOOST_FUNCTION_UNIQUE_TYPE_IDENTITY when these objects are known
+// to be unique in the program, e.g. when it is linked statically or its
+// shared libraries export their symbols, to skip that comparison.
+
+// When BOOST_FUNCTION_POOLED_ALLOCATION is defined, function objects that
+// do not fit in the small-object buffer of a function without an
+// allocator are placed in per-thread free lists of same-sized blocks
+// rather than allocated with new, bypassing any class-specific operator
+// new. It needs C++11 atomics and thread_local, and as blocks from the
+// pools must be freed to them, it must be defined identically in every
+// translation unit of a program. function_pool_allocator selects the
+// pools for individual functions instead.
+
+#if defined(BOOST_FUNCTION_POOLED_ALLOCATION)
+#  if defined(BOOST_NO_CXX11_HDR_ATOMIC) || defined(BOOST_NO_CXX11_THREAD_LOCAL)
+#    error "BOOST_FUNCTION_POOLED_ALLOCATION needs C++11 atomics and thread_local"
+#  endif
+#  include <boost/function/detail/size_class_pool.hpp>
+#endif
+
+// In C++17, the constructors and assign() members of functions that take
+// an allocator also take a std::pmr::memory_resource pointer, which
+// stands for a polymorphic_allocator using it. As the allocator is kept
+// with a function object stored on the heap, copies of the function
+// allocate from the same resource.
+#if !defined(BOOST_FUNCTION_NO_MEMORY_RESOURCE) && defined(__has_include)
+#  if (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)) && \
+      __has_include(<memory_resource>)
+#    include <memory_resource>
+#    if defined(__cpp_lib_memory_resource)
+#      define BOOST_FUNCTION_HAS_MEMORY_RESOURCE
+#    endif
+#  endif
+#endif
+
 namespace boost {
+  /**
+   * Whether an object of type F may be moved to a new address by
+   * copying its bytes, without running its move constructor or its
+   * destructor. Boost.Function then moves and swaps functions holding
+   * such targets with memcpy. Specialize it for function objects that
+   * qualify without being trivially copyable, e.g., ones holding a
+   * unique_ptr.
+   */
+  template<typename F>
+  struct is_trivially_relocatable
+    : integral_constant<bool, (has_trivial_copy_constructor<F>::value &&
+                               has_trivial_destructor<F>::value)>
+  {
+  };
+
+  /**
+   * Whether function_hash and function_identity_equal may hash and
+   * compare function objects of type F. Specialize it for function
+   * objects that provide hash_value() and function_equal(), found by
+   * argument-dependent lookup. Function pointers, member pointers,
+   * references and delegates are hashed without it.
+   */
+  template<typename F>
+  struct is_hashable_target : false_type {};
+
   namespace detail {
     namespace function {
       class X;
 
+      /**
+       * The address of functor_identity<F>::id identifies the type F
+       * without RTTI, at the cost of a pointer comparison. The managers
+       * compare it before the type_info objects, and vtables hold the
+       * identity of their target type. Like the vtables themselves, these
+       * objects are only unique within the program when the dynamic
+       * linker merges them, so a different address is not proof of a
+       * different type unless BOOST_FUNCTION_UNIQUE_TYPE_IDENTITY is
+       * defined.
+       */
+      template<typename F>
+      struct functor_identity
+      {
+        static const char id;
+      };
+
+      template<typename F> const char functor_identity<F>::id = 0;
+
       /**
        * A buffer used to store small function objects in
        * boost::function. It is a union containing function pointers,
@@ -76,6 +186,9 @@ namespace boost {
           // (get_functor_type_tag, check_functor_type_tag).
           const boost::typeindex::type_info* type;
 
+          // The identity of the type (check_functor_type_tag).
+          const char* identity;
+
           // Whether the type is const-qualified.
           bool const_qualified;
           // Whether the type is volatile-qualified.
@@ -110,6 +223,52 @@ namespace boost {
         mutable char data[sizeof(function_buffer_members)];
       };
 
+      /**
+       * The target of a boost::function_ref: a pointer to the referenced
+       * function object or member pointer, or a function pointer. It is
+       * passed by value to the invokers of function_ref.
+       */
+      union function_ref_target
+      {
+        function_buffer_members::obj_ptr_t obj_ptr;
+        function_buffer_members::func_ptr_t func_ptr;
+      };
+
+      /**
+       * Inline storage with a user-chosen size and alignment, used by
+       * boost::basic_function. It overlays a function_buffer, which is
+       * what the managers and invokers operate on, and exposes the same
+       * members so that the vtable can place function objects into
+       * either kind of storage.
+       */
+      template<std::size_t Size, std::size_t Align>
+      union function_storage
+      {
+        // The view handed to managers and invokers
+        function_buffer buffer;
+
+        // Type-specific union members
+        mutable function_buffer_members members;
+
+        // Room for function objects up to Size bytes
+        mutable char data[Size < sizeof(function_buffer) ? sizeof(function_buffer) : Size];
+
+        // Forces the requested alignment
+        typename type_with_alignment<Align>::type align;
+      };
+
+      inline function_buffer& get_function_buffer(function_buffer& storage)
+      {
+        return storage;
+      }
+
+      template<std::size_t Size, std::size_t Align>
+      inline function_buffer&
+      get_function_buffer(function_storage<Size, Align>& storage)
+      {
+        return storage.buffer;
+      }
+
       /**
        * The unusable class is a placeholder for unused function arguments
        * It is also completely unusable except that it constructable from
@@ -148,6 +307,13 @@ namespace boost {
       struct function_obj_tag {};
       struct member_ptr_tag {};
       struct function_obj_ref_tag {};
+      struct delegate_tag {};
+
+      template<typename F>
+      struct is_delegate : false_type {};
+
+      template<typename T, typename MemberPtr>
+      struct is_delegate<boost::delegate<T, MemberPtr> > : true_type {};
 
       template<typename F>
       class get_function_tag
@@ -164,10 +330,28 @@ namespace boost {
                                    function_obj_ref_tag,
                                    ptr_or_obj_or_mem_tag>::type or_ref_tag;
 
+        typedef typename conditional<(is_delegate<F>::value),
+                                   delegate_tag,
+                                   or_ref_tag>::type or_delegate_tag;
+
       public:
-        typedef or_ref_tag type;
+        typedef or_delegate_tag type;
       };
 
+      // Whether the type asked for with check_functor_type_tag is F,
+      // ignoring cv-qualifiers
+      template<typename F>
+      inline bool is_requested_type(const function_buffer& out_buffer)
+      {
+        typedef typename remove_cv<F>::type type;
+#ifdef BOOST_FUNCTION_UNIQUE_TYPE_IDENTITY
+        return out_buffer.members.type.identity == &functor_identity<type>::id;
+#else
+        return out_buffer.members.type.identity == &functor_identity<type>::id ||
+          *out_buffer.members.type.type == boost::typeindex::type_id<type>();
+#endif
+      }
+
       // The trivial manager does nothing but return the same pointer (if we
       // are cloning) or return the null pointer (if we are deleting).
       template<typename F>
@@ -195,7 +379,7 @@ namespace boost {
             {
               // Check whether we have the same type. We can add
               // cv-qualifiers, but we can't take them away.
-              if (*out_buffer.members.type.type == boost::typeindex::type_id<F>()
+              if (is_requested_type<F>(out_buffer)
                   && (!in_buffer.members.obj_ref.is_const_qualified
                       || out_buffer.members.type.const_qualified)
                   && (!in_buffer.members.obj_ref.is_volatile_qualified
@@ -215,28 +399,134 @@ namespace boost {
         }
       };
 
+      // Delegates live in the bound_memfunc_ptr member of the buffer,
+      // which is copied as is and needs no destruction.
+      template<typename Delegate>
+      struct delegate_manager
+      {
+        static inline void
+        manage(const function_buffer& in_buffer, function_buffer& out_buffer,
+               functor_manager_operation_type op)
+        {
+          switch (op) {
+          case clone_functor_tag:
+          case move_functor_tag:
+            out_buffer.members.bound_memfunc_ptr = in_buffer.members.bound_memfunc_ptr;
+            return;
+
+          case destroy_functor_tag:
+            return;
+
+          case check_functor_type_tag:
+            if (is_requested_type<Delegate>(out_buffer))
+              out_buffer.members.obj_ptr = &in_buffer.members.bound_memfunc_ptr;
+            else
+              out_buffer.members.obj_ptr = 0;
+            return;
+
+          case get_functor_type_tag:
+            out_buffer.members.type.type = &boost::typeindex::type_id<Delegate>().type_info();
+            out_buffer.members.type.const_qualified = false;
+            out_buffer.members.type.volatile_qualified = false;
+            return;
+          }
+        }
+      };
+
       /**
        * Determine if boost::function can use the small-object
-       * optimization with the function object type F.
+       * optimization with the function object type F, given the
+       * inline Storage of the function object.
        */
-      template<typename F>
+      template<typename F, typename Storage = function_buffer>
       struct function_allows_small_object_optimization
       {
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+        // Moving a boost::function never throws, so a function object
+        // stored inline must be nothrow-move-constructible.
+        BOOST_STATIC_CONSTANT(bool, nothrow_move = is_nothrow_move_constructible<F>::value);
+#else
+        BOOST_STATIC_CONSTANT(bool, nothrow_move = true);
+#endif
+
         BOOST_STATIC_CONSTANT
           (bool,
-           value = ((sizeof(F) <= sizeof(function_buffer) &&
-                     (alignment_of<function_buffer>::value
-                      % alignment_of<F>::value == 0))));
+           value = ((sizeof(F) <= sizeof(Storage) &&
+                     (alignment_of<Storage>::value
+                      % alignment_of<F>::value == 0) &&
+                     nothrow_move)));
+      };
+
+      /**
+       * Whether boost::function stores F in the given inline Storage.
+       * Function pointers, member pointers and references to function
+       * objects always fit; other function objects need the small-object
+       * optimization.
+       */
+      template<typename F, typename Storage,
+               typename Tag = typename get_function_tag<F>::type>
+      struct is_stored_inline
+      {
+        BOOST_STATIC_CONSTANT(bool, value = true);
+      };
+
+      template<typename F, typename Storage>
+      struct is_stored_inline<F, Storage, function_obj_tag>
+      {
+        BOOST_STATIC_CONSTANT
+          (bool,
+           value = (function_allows_small_object_optimization<F, Storage>::value));
+      };
+
+      /**
+       * The allocator that functions use when given a: a itself, or for
+       * a pointer to a memory resource, a polymorphic_allocator using the
+       * resource, or the default resource if the pointer is null.
+       */
+#ifdef BOOST_FUNCTION_HAS_MEMORY_RESOURCE
+      template<typename Allocator,
+               bool Resource = is_convertible<Allocator, std::pmr::memory_resource*>::value>
+      struct function_allocator
+      {
+        typedef Allocator type;
+        static const Allocator& get(const Allocator& a) { return a; }
+      };
+
+      template<typename Allocator>
+      struct function_allocator<Allocator, true>
+      {
+        typedef std::pmr::polymorphic_allocator<char> type;
+        static type get(std::pmr::memory_resource* r)
+        {
+          return type(r ? r : std::pmr::get_default_resource());
+        }
       };
+#else
+      template<typename Allocator, bool Resource = false>
+      struct function_allocator
+      {
+        typedef Allocator type;
+        static const Allocator& get(const Allocator& a) { return a; }
+      };
+#endif
 
       template <typename F,typename A>
       struct functor_wrapper: public F, public A
       {
-        functor_wrapper( F f, A a ):
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+        template<typename G>
+        functor_wrapper( G&& f, const A& a ):
+          F(static_cast<G&&>(f)),
+          A(a)
+        {
+        }
+#else
+        functor_wrapper( const F& f, const A& a ):
           F(f),
           A(a)
         {
         }
+#endif
 
         functor_wrapper(const functor_wrapper& f) :
           F(static_cast<const F&>(f)),
@@ -245,11 +535,103 @@ namespace boost {
         }
       };
 
+      /**
+       * Whether a function object is more strictly aligned than operator
+       * new guarantees before C++17. Such function objects are placed in
+       * memory from boost::alignment::aligned_alloc when they go to the
+       * heap. This happens in every language mode, so that translation
+       * units compiled with different standards agree on how to free
+       * them.
+       */
+      template<typename F>
+      struct is_over_aligned
+      {
+        BOOST_STATIC_CONSTANT
+          (bool,
+           value = (alignment_of<F>::value >
+                    alignment_of<boost::detail::max_align>::value));
+      };
+
+      template<typename F>
+      inline void* allocate_over_aligned()
+      {
+        void* p = boost::alignment::aligned_alloc(alignment_of<F>::value, sizeof(F));
+        if (!p)
+          boost::throw_exception(std::bad_alloc());
+        return p;
+      }
+
+      // Copies or moves f to the heap, from the pool of its size class
+      // under BOOST_FUNCTION_POOLED_ALLOCATION
+      template<typename F>
+      inline typename decay<F>::type*
+      new_functor(BOOST_FUNCTION_FWD_REF(F) f, false_type)
+      {
+        typedef typename decay<F>::type FunctionObj;
+#ifdef BOOST_FUNCTION_POOLED_ALLOCATION
+        void* p = size_class_pool::allocate(sizeof(FunctionObj));
+        FunctionObj* result = 0;
+        BOOST_TRY {
+          result = new (p) FunctionObj(BOOST_FUNCTION_FORWARD(F, f));
+        } BOOST_CATCH (...) {
+          size_class_pool::deallocate(p, sizeof(FunctionObj));
+          BOOST_RETHROW;
+        }
+        BOOST_CATCH_END
+        return result;
+#else
+        return new FunctionObj(BOOST_FUNCTION_FORWARD(F, f));
+#endif
+      }
+
+      // Over-aligned function objects get suitably aligned memory
+      template<typename F>
+      inline typename decay<F>::type*
+      new_functor(BOOST_FUNCTION_FWD_REF(F) f, true_type)
+      {
+        typedef typename decay<F>::type FunctionObj;
+        void* p = allocate_over_aligned<FunctionObj>();
+        FunctionObj* result = 0;
+        BOOST_TRY {
+          result = new (p) FunctionObj(BOOST_FUNCTION_FORWARD(F, f));
+        } BOOST_CATCH (...) {
+          boost::alignment::aligned_free(p);
+          BOOST_RETHROW;
+        }
+        BOOST_CATCH_END
+        return result;
+      }
+
+#ifdef BOOST_FUNCTION_POOLED_ALLOCATION
+      template<typename F>
+      inline void delete_functor(F* f, false_type)
+      {
+        f->~F();
+        size_class_pool::deallocate(f, sizeof(F));
+      }
+#else
+      template<typename F>
+      inline void delete_functor(F* f, false_type)
+      {
+        delete f;
+      }
+#endif
+
+      template<typename F>
+      inline void delete_functor(F* f, true_type)
+      {
+        f->~F();
+        boost::alignment::aligned_free(f);
+      }
+
       /**
        * The functor_manager class contains a static function "manage" which
        * can clone or destroy the given function/function object pointer.
+       * Managers of move-only function objects (Copyable is false) are
+       * never asked to clone, since the functions holding them cannot be
+       * copied.
        */
-      template<typename Functor>
+      template<typename Functor, bool Copyable = true>
       struct functor_manager_common
       {
         typedef Functor functor_type;
@@ -267,7 +649,7 @@ namespace boost {
           } else if (op == destroy_functor_tag)
             out_buffer.members.func_ptr = 0;
           else if (op == check_functor_type_tag) {
-            if (*out_buffer.members.type.type == boost::typeindex::type_id<Functor>())
+            if (is_requested_type<Functor>(out_buffer))
               out_buffer.members.obj_ptr = &in_buffer.members.func_ptr;
             else
               out_buffer.members.obj_ptr = 0;
@@ -283,23 +665,23 @@ namespace boost {
         manage_small(const function_buffer& in_buffer, function_buffer& out_buffer,
                 functor_manager_operation_type op)
         {
-          if (op == clone_functor_tag || op == move_functor_tag) {
-            const functor_type* in_functor =
-              reinterpret_cast<const functor_type*>(in_buffer.data);
-            new (reinterpret_cast<void*>(out_buffer.data)) functor_type(*in_functor);
-
-            if (op == move_functor_tag) {
-              functor_type* f = reinterpret_cast<functor_type*>(in_buffer.data);
-              (void)f; // suppress warning about the value of f not being used (MSVC)
-              f->~Functor();
-            }
+          if (op == clone_functor_tag) {
+            clone_small(in_buffer, out_buffer, integral_constant<bool, Copyable>());
+          } else if (op == move_functor_tag) {
+            functor_type* f = reinterpret_cast<functor_type*>(in_buffer.data);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+            new (reinterpret_cast<void*>(out_buffer.data)) functor_type(static_cast<functor_type&&>(*f));
+#else
+            new (reinterpret_cast<void*>(out_buffer.data)) functor_type(*f);
+#endif
+            f->~Functor();
           } else if (op == destroy_functor_tag) {
             // Some compilers (Borland, vc6, ...) are unhappy with ~functor_type.
              functor_type* f = reinterpret_cast<functor_type*>(out_buffer.data);
              (void)f; // suppress warning about the value of f not being used (MSVC)
              f->~Functor();
           } else if (op == check_functor_type_tag) {
-             if (*out_buffer.members.type.type == boost::typeindex::type_id<Functor>())
+             if (is_requested_type<Functor>(out_buffer))
               out_buffer.members.obj_ptr = in_buffer.data;
             else
               out_buffer.members.obj_ptr = 0;
@@ -309,9 +691,27 @@ namespace boost {
             out_buffer.members.type.volatile_qualified = false;
           }
         }
+
+      private:
+        static inline void
+        clone_small(const function_buffer& in_buffer, function_buffer& out_buffer,
+                    true_type)
+        {
+          const functor_type* in_functor =
+            reinterpret_cast<const functor_type*>(in_buffer.data);
+          new (reinterpret_cast<void*>(out_buffer.data)) functor_type(*in_functor);
+        }
+
+        static inline void
+        clone_small(const function_buffer&, function_buffer&, false_type)
+        {
+          BOOST_ASSERT(false);
+        }
       };
 
-      template<typename Functor>
+      template<typename Functor, typename Storage = function_buffer,
+               bool Copyable = true,
+               bool SmallObject = function_allows_small_object_optimization<Functor, Storage>::value>
       struct functor_manager
       {
       private:
@@ -330,7 +730,7 @@ namespace boost {
         manager(const function_buffer& in_buffer, function_buffer& out_buffer,
                 functor_manager_operation_type op, true_type)
         {
-          functor_manager_common<Functor>::manage_small(in_buffer,out_buffer,op);
+          functor_manager_common<Functor, Copyable>::manage_small(in_buffer,out_buffer,op);
         }
 
         // Function objects that require heap allocation
@@ -339,15 +739,7 @@ namespace boost {
                 functor_manager_operation_type op, false_type)
         {
           if (op == clone_functor_tag) {
-            // Clone the functor
-            // GCC 2.95.3 gets the CV qualifiers wrong here, so we
-            // can't do the static_cast that we should do.
-            // jewillco: Changing this to static_cast because GCC 2.95.3 is
-            // obsolete.
-            const functor_type* f =
-              static_cast<const functor_type*>(in_buffer.members.obj_ptr);
-            functor_type* new_f = new functor_type(*f);
-            out_buffer.members.obj_ptr = new_f;
+            clone(in_buffer, out_buffer, integral_constant<bool, Copyable>());
           } else if (op == move_functor_tag) {
             out_buffer.members.obj_ptr = in_buffer.members.obj_ptr;
             in_buffer.members.obj_ptr = 0;
@@ -355,10 +747,10 @@ namespace boost {
             /* Cast from the void pointer to the functor pointer type */
             functor_type* f =
               static_cast<functor_type*>(out_buffer.members.obj_ptr);
-            delete f;
+            delete_functor(f, integral_constant<bool, is_over_aligned<functor_type>::value>());
             out_buffer.members.obj_ptr = 0;
           } else if (op == check_functor_type_tag) {
-            if (*out_buffer.members.type.type == boost::typeindex::type_id<Functor>())
+            if (is_requested_type<Functor>(out_buffer))
               out_buffer.members.obj_ptr = in_buffer.members.obj_ptr;
             else
               out_buffer.members.obj_ptr = 0;
@@ -369,15 +761,37 @@ namespace boost {
           }
         }
 
+        // Clone a function object allocated on the heap
+        static inline void
+        clone(const function_buffer& in_buffer, function_buffer& out_buffer,
+              true_type)
+        {
+          // GCC 2.95.3 gets the CV qualifiers wrong here, so we
+          // can't do the static_cast that we should do.
+          // jewillco: Changing this to static_cast because GCC 2.95.3 is
+          // obsolete.
+          const functor_type* f =
+            static_cast<const functor_type*>(in_buffer.members.obj_ptr);
+          functor_type* new_f =
+            new_functor(*f, integral_constant<bool, is_over_aligned<functor_type>::value>());
+          out_buffer.members.obj_ptr = new_f;
+        }
+
+        static inline void
+        clone(const function_buffer&, function_buffer&, false_type)
+        {
+          BOOST_ASSERT(false);
+        }
+
         // For function objects, we determine whether the function
         // object can use the small-object optimization buffer or
-        // whether we need to allocate it on the heap.
+        // whether we need to allocate it on the heap. The decision is
+        // a template argument so that it is part of the manager's type.
         static inline void
         manager(const function_buffer& in_buffer, function_buffer& out_buffer,
                 functor_manager_operation_type op, function_obj_tag)
         {
-          manager(in_buffer, out_buffer, op,
-                  integral_constant<bool, (function_allows_small_object_optimization<functor_type>::value)>());
+          manager(in_buffer, out_buffer, op, integral_constant<bool, SmallObject>());
         }
 
         // For member pointers, we use the small-object optimization buffer.
@@ -406,7 +820,10 @@ namespace boost {
         }
       };
 
-      template<typename Functor, typename Allocator>
+      template<typename Functor, typename Allocator,
+               typename Storage = function_buffer,
+               bool Copyable = true,
+               bool SmallObject = function_allows_small_object_optimization<Functor, Storage>::value>
       struct functor_manager_a
       {
       private:
@@ -425,41 +842,26 @@ namespace boost {
         manager(const function_buffer& in_buffer, function_buffer& out_buffer,
                 functor_manager_operation_type op, true_type)
         {
-          functor_manager_common<Functor>::manage_small(in_buffer,out_buffer,op);
+          functor_manager_common<Functor, Copyable>::manage_small(in_buffer,out_buffer,op);
         }
 
+        typedef functor_wrapper<Functor,Allocator> functor_wrapper_type;
+#if defined(BOOST_NO_CXX11_ALLOCATOR)
+        typedef typename Allocator::template rebind<functor_wrapper_type>::other
+          wrapper_allocator_type;
+        typedef typename wrapper_allocator_type::pointer wrapper_allocator_pointer_type;
+#else
+        using wrapper_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<functor_wrapper_type>;
+        using wrapper_allocator_pointer_type = typename std::allocator_traits<wrapper_allocator_type>::pointer;
+#endif
+
         // Function objects that require heap allocation
         static inline void
         manager(const function_buffer& in_buffer, function_buffer& out_buffer,
                 functor_manager_operation_type op, false_type)
         {
-          typedef functor_wrapper<Functor,Allocator> functor_wrapper_type;
-#if defined(BOOST_NO_CXX11_ALLOCATOR)
-          typedef typename Allocator::template rebind<functor_wrapper_type>::other
-            wrapper_allocator_type;
-          typedef typename wrapper_allocator_type::pointer wrapper_allocator_pointer_type;
-#else
-          using wrapper_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<functor_wrapper_type>;
-          using wrapper_allocator_pointer_type = typename std::allocator_traits<wrapper_allocator_type>::pointer;
-#endif
-
           if (op == clone_functor_tag) {
-            // Clone the functor
-            // GCC 2.95.3 gets the CV qualifiers wrong here, so we
-            // can't do the static_cast that we should do.
-            const functor_wrapper_type* f =
-              static_cast<const functor_wrapper_type*>(in_buffer.members.obj_ptr);
-            wrapper_allocator_type wrapper_allocator(static_cast<Allocator const &>(*f));
-            wrapper_allocator_pointer_type copy = wrapper_allocator.allocate(1);
-#if defined(BOOST_NO_CXX11_ALLOCATOR)
-            wrapper_allocator.construct(copy, *f);
-#else
-            std::allocator_traits<wrapper_allocator_type>::construct(wrapper_allocator, copy, *f);
-#endif
-
-            // Get back to the original pointer type
-            functor_wrapper_type* new_f = static_cast<functor_wrapper_type*>(copy);
-            out_buffer.members.obj_ptr = new_f;
+            clone(in_buffer, out_buffer, integral_constant<bool, Copyable>());
           } else if (op == move_functor_tag) {
             out_buffer.members.obj_ptr = in_buffer.members.obj_ptr;
             in_buffer.members.obj_ptr = 0;
@@ -476,7 +878,7 @@ namespace boost {
             wrapper_allocator.deallocate(victim,1);
             out_buffer.members.obj_ptr = 0;
           } else if (op == check_functor_type_tag) {
-            if (*out_buffer.members.type.type == boost::typeindex::type_id<Functor>())
+            if (is_requested_type<Functor>(out_buffer))
               out_buffer.members.obj_ptr = in_buffer.members.obj_ptr;
             else
               out_buffer.members.obj_ptr = 0;
@@ -487,15 +889,43 @@ namespace boost {
           }
         }
 
+        // Clone a function object allocated with the allocator
+        static inline void
+        clone(const function_buffer& in_buffer, function_buffer& out_buffer,
+              true_type)
+        {
+          // GCC 2.95.3 gets the CV qualifiers wrong here, so we
+          // can't do the static_cast that we should do.
+          const functor_wrapper_type* f =
+            static_cast<const functor_wrapper_type*>(in_buffer.members.obj_ptr);
+          wrapper_allocator_type wrapper_allocator(static_cast<Allocator const &>(*f));
+          wrapper_allocator_pointer_type copy = wrapper_allocator.allocate(1);
+#if defined(BOOST_NO_CXX11_ALLOCATOR)
+          wrapper_allocator.construct(copy, *f);
+#else
+          std::allocator_traits<wrapper_allocator_type>::construct(wrapper_allocator, copy, *f);
+#endif
+
+          // Get back to the original pointer type
+          functor_wrapper_type* new_f = static_cast<functor_wrapper_type*>(copy);
+          out_buffer.members.obj_ptr = new_f;
+        }
+
+        static inline void
+        clone(const function_buffer&, function_buffer&, false_type)
+        {
+          BOOST_ASSERT(false);
+        }
+
         // For function objects, we determine whether the function
         // object can use the small-object optimization buffer or
-        // whether we need to allocate it on the heap.
+        // whether we need to allocate it on the heap. The decision is
+        // a template argument so that it is part of the manager's type.
         static inline void
         manager(const function_buffer& in_buffer, function_buffer& out_buffer,
                 functor_manager_operation_type op, function_obj_tag)
         {
-          manager(in_buffer, out_buffer, op,
-                  integral_constant<bool, (function_allows_small_object_optimization<functor_type>::value)>());
+          manager(in_buffer, out_buffer, op, integral_constant<bool, SmallObject>());
         }
 
       public:
@@ -516,9 +946,41 @@ namespace boost {
         }
       };
 
+      // Whether memory from Allocator is reclaimed all at once, so that
+      // deallocating a single object does nothing
+      template<typename Allocator>
+      struct allocator_reclaims_in_bulk : false_type {};
+
+      // Whether destroying the function objects that Manager keeps has
+      // no effect besides running their destructor
+      template<typename Manager>
+      struct manager_destroys_in_place : false_type {};
+
+      template<typename Functor, typename Allocator, typename Storage,
+               bool Copyable, bool SmallObject>
+      struct manager_destroys_in_place<
+               functor_manager_a<Functor, Allocator, Storage, Copyable, SmallObject> >
+        : allocator_reclaims_in_bulk<Allocator> {};
+
       // A type that is only used for comparisons against zero
       struct useless_clear_type {};
 
+      // Whether the forwarding constructors and assignment operators of
+      // Function accept an argument of type Functor. Integers are
+      // reserved for clearing, and Function and its Base are handled by
+      // the copy and move members.
+      template<typename Functor, typename Function, typename Base = Function>
+      struct is_assignable_functor
+      {
+        typedef typename decay<Functor>::type functor_type;
+
+        BOOST_STATIC_CONSTANT
+          (bool,
+           value = (!is_integral<functor_type>::value &&
+                    !is_same<functor_type, Function>::value &&
+                    !is_same<functor_type, Base>::value));
+      };
+
 #ifdef BOOST_NO_SFINAE
       // These routines perform comparisons between a Boost.Function
       // object and an arbitrary function object (when the last
@@ -579,53 +1041,371 @@ namespace boost {
 #endif // BOOST_NO_SFINAE
 
       /**
-       * Stores the "manager" portion of the vtable for a
-       * boost::function object.
+       * The targets that target() finds without asking the manager:
+       * function pointers and function objects assigned without an
+       * allocator. Their vtables hold the identity of their type, those
+       * of all other targets and of empty functions the identity of
+       * void. Whether a function object is stored inline is in the tag
+       * bits of the vtable pointer.
        */
-      struct vtable_base
+      template<typename F, typename Tag = typename get_function_tag<F>::type>
+      struct identity_type { typedef void type; };
+
+      template<typename F>
+      struct identity_type<F, function_obj_tag> { typedef F type; };
+
+      template<typename F>
+      struct identity_type<F, function_ptr_tag> { typedef F type; };
+
+      /**
+       * The part of a vtable that does not depend on the signature. The
+       * manager answers the type queries of target() and target_type().
+       * Copying, moving and destroying the target have entries of their
+       * own, so that these hot paths do not dispatch on the operation;
+       * an entry is null when the function classes do it with a memcpy
+       * or when there is nothing to do.
+       */
+      struct BOOST_ALIGNMENT(16) vtable_base
       {
         void (*manager)(const function_buffer& in_buffer,
                         function_buffer& out_buffer,
                         functor_manager_operation_type op);
+        void (*clone)(const function_buffer& in_buffer,
+                      function_buffer& out_buffer);
+        void (*move)(const function_buffer& in_buffer,
+                     function_buffer& out_buffer);
+        void (*destroy)(function_buffer& buffer);
+        // The address of functor_identity<T>::id for the stored type T
+        const char* identity;
+        // Hash and compare targets for function_hash and
+        // function_identity_equal, or null when the target does not
+        // support it
+        std::size_t (*hash)(const function_buffer& buffer);
+        bool (*equal)(const function_buffer& buffer, const function_buffer& other);
+      };
+
+      // The manager of empty functions: there is nothing to copy, move
+      // or destroy, and the target type is void
+      inline void empty_manager(const function_buffer&, function_buffer& out_buffer,
+                                functor_manager_operation_type op)
+      {
+        if (op == check_functor_type_tag)
+          out_buffer.members.obj_ptr = 0;
+        else if (op == get_functor_type_tag) {
+          out_buffer.members.type.type = &boost::typeindex::type_id<void>().type_info();
+          out_buffer.members.type.const_qualified = false;
+          out_buffer.members.type.volatile_qualified = false;
+        }
+      }
+
+      // Empty functions hash alike and compare equal to each other
+      inline std::size_t empty_hash(const function_buffer&) { return 0; }
+
+      inline bool empty_equal(const function_buffer&, const function_buffer&)
+      {
+        return true;
+      }
+
+      // The vtable of empty function_base objects. The function classes
+      // use a vtable of their signature instead, with the same manager.
+      inline vtable_base* empty_vtable_base()
+      {
+        static const vtable_base stored_vtable =
+          { &empty_manager, 0, 0, 0, &functor_identity<void>::id,
+            &empty_hash, &empty_equal };
+        return reinterpret_cast<vtable_base*>(
+                 reinterpret_cast<std::size_t>(&stored_vtable) | 0x07);
+      }
+
+      // The invoker of a vtable with its signature erased, as cached in
+      // the function objects when BOOST_FUNCTION_CACHE_INVOKER is defined
+      typedef void (*generic_invoker)();
+
+      // The four low bits of a vtable pointer are used as tags. Bit 2
+      // marks the empty vtables, so that emptiness does not depend on
+      // comparing addresses, which differ across shared libraries.
+      BOOST_STATIC_ASSERT(alignment_of<vtable_base>::value >= 16);
+
+      /**
+       * The tag bits stored in the vtable pointer of a function holding a
+       * Functor in the given Storage. Bit 0 is set when the target is
+       * stored inline and is trivially copyable and destructible, so that
+       * copies are a memcpy and destruction does nothing. Bit 1 is set
+       * when the target can be moved with a memcpy of the buffer: targets
+       * on the heap, function pointers and references always can, and
+       * inline function objects can when they are trivially relocatable.
+       * Bit 3 is set when the target is stored inline, as Inline tells.
+       * The identity in the vtable does not record this, and translation
+       * units built with different language standards may disagree on
+       * it, so target() reads it from here.
+       */
+      template<typename Functor, typename Storage,
+               bool Inline = is_stored_inline<Functor, Storage>::value>
+      struct vtable_tag_bits
+      {
+        BOOST_STATIC_CONSTANT
+          (bool,
+           trivial = (has_trivial_copy_constructor<Functor>::value &&
+                      has_trivial_destructor<Functor>::value &&
+                      Inline));
+
+        BOOST_STATIC_CONSTANT
+          (bool,
+           relocatable = (trivial ||
+                          !is_same<typename get_function_tag<Functor>::type,
+                                   function_obj_tag>::value ||
+                          !Inline ||
+                          is_trivially_relocatable<Functor>::value));
+
+        BOOST_STATIC_CONSTANT
+          (std::size_t,
+           value = ((trivial ? 0x01 : 0) | (relocatable ? 0x02 : 0) |
+                    (Inline ? 0x08 : 0)));
+      };
+
+      inline std::size_t hash_mix(std::size_t seed, std::size_t value)
+      {
+        return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+      }
+
+      // FNV-1a over the object representation
+      inline std::size_t hash_bytes(const void* p, std::size_t size)
+      {
+        const unsigned char* bytes = static_cast<const unsigned char*>(p);
+        std::size_t h = 2166136261u;
+        for (std::size_t i = 0; i < size; ++i)
+          h = (h ^ bytes[i]) * 16777619u;
+        return h;
+      }
+
+      // Function objects without is_hashable_target
+      struct unhashable_tag {};
+
+      template<typename F>
+      struct get_hash_tag
+      {
+        typedef typename get_function_tag<F>::type tag;
+
+        typedef typename conditional<(is_same<tag, function_obj_tag>::value &&
+                                      !is_hashable_target<F>::value),
+                                     unhashable_tag,
+                                     tag>::type type;
+      };
+
+      template<typename T, typename MemberPtr>
+      inline std::size_t hash_delegate(const boost::delegate<T, MemberPtr>& d)
+      {
+        MemberPtr member = d.member();
+        return hash_mix(reinterpret_cast<std::size_t>(d.object()),
+                        hash_bytes(&member, sizeof(MemberPtr)));
+      }
+
+      template<typename T, typename MemberPtr>
+      inline bool equal_delegates(const boost::delegate<T, MemberPtr>& d,
+                                  const boost::delegate<T, MemberPtr>& e)
+      {
+        return d.object() == e.object() && d.member() == e.member();
+      }
+
+      /**
+       * The per-operation vtable entries for a Functor held in Storage
+       * and managed by Manager. Each passes a constant operation to the
+       * manager, so that its dispatch folds away. The flags tell which
+       * entries the vtable leaves null: cloning and moving when the tag
+       * bits make them a memcpy, and destruction when the target is
+       * trivially destructible and either stored inline or allocated
+       * from memory that is reclaimed in bulk.
+       */
+      template<typename Manager, typename Functor, typename Storage>
+      struct vtable_entries
+      {
+        BOOST_STATIC_CONSTANT
+          (bool, trivial_clone = (vtable_tag_bits<Functor, Storage>::trivial));
+
+        BOOST_STATIC_CONSTANT
+          (bool, trivial_move = (vtable_tag_bits<Functor, Storage>::relocatable));
+
+        BOOST_STATIC_CONSTANT
+          (bool,
+           trivial_destroy = ((is_stored_inline<Functor, Storage>::value ||
+                               manager_destroys_in_place<Manager>::value) &&
+                              has_trivial_destructor<Functor>::value));
+
+        static void clone(const function_buffer& in_buffer, function_buffer& out_buffer)
+        {
+          Manager::manage(in_buffer, out_buffer, clone_functor_tag);
+        }
+
+        static void move(const function_buffer& in_buffer, function_buffer& out_buffer)
+        {
+          Manager::manage(in_buffer, out_buffer, move_functor_tag);
+        }
+
+        static void destroy(function_buffer& buffer)
+        {
+          Manager::manage(buffer, buffer, destroy_functor_tag);
+        }
+
+        // The identity of the vtable when Manager is the default manager
+        typedef functor_identity<typename identity_type<Functor>::type> identity;
+
+        typedef typename get_hash_tag<Functor>::type hash_tag;
+
+        BOOST_STATIC_CONSTANT
+          (bool, hashable = (!is_same<hash_tag, unhashable_tag>::value));
+
+        // The hash of the target, mixed with an identity of its type and
+        // manager so that it agrees with equal()
+        static std::size_t hash(const function_buffer& buffer)
+        {
+          return hash_mix(reinterpret_cast<std::size_t>(&functor_identity<vtable_entries>::id),
+                          hash_target(buffer, hash_tag()));
+        }
+
+        // Compares the target with that of another function using the
+        // same entries
+        static bool equal(const function_buffer& buffer, const function_buffer& other)
+        {
+          return equal_targets(buffer, other, hash_tag());
+        }
+
+      private:
+        static const Functor& get_target(const function_buffer& buffer)
+        {
+          function_buffer request;
+          request.members.type.type = &boost::typeindex::type_id<Functor>().type_info();
+          request.members.type.identity = &functor_identity<Functor>::id;
+          request.members.type.const_qualified = true;
+          request.members.type.volatile_qualified = false;
+          Manager::manage(buffer, request, check_functor_type_tag);
+          return *static_cast<const Functor*>(request.members.obj_ptr);
+        }
+
+        static std::size_t hash_target(const function_buffer& buffer, function_ptr_tag)
+        {
+          return hash_bytes(&get_target(buffer), sizeof(Functor));
+        }
+
+        static std::size_t hash_target(const function_buffer& buffer, member_ptr_tag)
+        {
+          return hash_bytes(&get_target(buffer), sizeof(Functor));
+        }
+
+        static std::size_t hash_target(const function_buffer& buffer, delegate_tag)
+        {
+          return hash_delegate(get_target(buffer));
+        }
+
+        static std::size_t hash_target(const function_buffer& buffer, function_obj_ref_tag)
+        {
+          return reinterpret_cast<std::size_t>(buffer.members.obj_ref.obj_ptr);
+        }
+
+        static std::size_t hash_target(const function_buffer& buffer, function_obj_tag)
+        {
+          return hash_value(get_target(buffer));
+        }
+
+        static std::size_t hash_target(const function_buffer&, unhashable_tag)
+        {
+          return 0;
+        }
+
+        static bool equal_targets(const function_buffer& buffer,
+                                  const function_buffer& other, function_ptr_tag)
+        {
+          return get_target(buffer) == get_target(other);
+        }
+
+        static bool equal_targets(const function_buffer& buffer,
+                                  const function_buffer& other, member_ptr_tag)
+        {
+          return get_target(buffer) == get_target(other);
+        }
+
+        static bool equal_targets(const function_buffer& buffer,
+                                  const function_buffer& other, delegate_tag)
+        {
+          return equal_delegates(get_target(buffer), get_target(other));
+        }
+
+        static bool equal_targets(const function_buffer& buffer,
+                                  const function_buffer& other, function_obj_ref_tag)
+        {
+          return buffer.members.obj_ref.obj_ptr == other.members.obj_ref.obj_ptr
+            && buffer.members.obj_ref.is_const_qualified ==
+                 other.members.obj_ref.is_const_qualified
+            && buffer.members.obj_ref.is_volatile_qualified ==
+                 other.members.obj_ref.is_volatile_qualified;
+        }
+
+        static bool equal_targets(const function_buffer& buffer,
+                                  const function_buffer& other, function_obj_tag)
+        {
+          return function_equal(get_target(buffer), get_target(other));
+        }
+
+        static bool equal_targets(const function_buffer&, const function_buffer&,
+                                  unhashable_tag)
+        {
+          return false;
+        }
       };
     } // end namespace function
   } // end namespace detail
 
 /**
- * The function_base class contains the basic elements needed for the
- * function1, function2, function3, etc. classes. It is common to all
- * functions (and as such can be used to tell if we have one of the
- * functionN objects).
+ * The basic_function_base class template contains the basic elements
+ * needed for the function1, function2, function3, etc. classes. It is
+ * common to all functions (and as such can be used to tell if we have
+ * one of the functionN objects). The Storage parameter is the inline
+ * buffer used for the small-object optimization; boost::function_base
+ * derives from the instance using the default function_buffer.
  */
-class function_base
+template<typename Storage>
+class basic_function_base
 {
 public:
-  function_base() : vtable(0) { }
+#ifdef BOOST_FUNCTION_CACHE_INVOKER
+  basic_function_base()
+    : vtable(detail::function::empty_vtable_base()), invoker(0) { }
+#else
+  basic_function_base() : vtable(detail::function::empty_vtable_base()) { }
+#endif
 
   /** Determine if the function is empty (i.e., has no target). */
-  bool empty() const { return !vtable; }
+  bool empty() const
+  {
+    return (reinterpret_cast<std::size_t>(vtable) & 0x04) != 0;
+  }
 
   /** Retrieve the type of the stored function object, or type_id<void>()
       if this is empty. */
   const boost::typeindex::type_info& target_type() const
   {
-    if (!vtable) return boost::typeindex::type_id<void>().type_info();
-
     detail::function::function_buffer type;
-    get_vtable()->manager(functor, type, detail::function::get_functor_type_tag);
+    get_vtable()->manager(get_functor_buffer(), type,
+                          detail::function::get_functor_type_tag);
     return *type.members.type.type;
   }
 
   template<typename Functor>
     Functor* target()
     {
-      if (!vtable) return 0;
+      if (has_identity<Functor>())
+        return static_cast<Functor*>(known_target<Functor>());
+#ifdef BOOST_FUNCTION_UNIQUE_TYPE_IDENTITY
+      if (has_unique_identity())
+        return 0;
+#endif
 
       detail::function::function_buffer type_result;
       type_result.members.type.type = &boost::typeindex::type_id<Functor>().type_info();
+      type_result.members.type.identity =
+        &detail::function::functor_identity<typename remove_cv<Functor>::type>::id;
       type_result.members.type.const_qualified = is_const<Functor>::value;
       type_result.members.type.volatile_qualified = is_volatile<Functor>::value;
-      get_vtable()->manager(functor, type_result,
+      get_vtable()->manager(get_functor_buffer(), type_result,
                       detail::function::check_functor_type_tag);
       return static_cast<Functor*>(type_result.members.obj_ptr);
     }
@@ -633,13 +1413,20 @@ public:
   template<typename Functor>
     const Functor* target() const
     {
-      if (!vtable) return 0;
+      if (has_identity<Functor>())
+        return static_cast<const Functor*>(known_target<Functor>());
+#ifdef BOOST_FUNCTION_UNIQUE_TYPE_IDENTITY
+      if (has_unique_identity())
+        return 0;
+#endif
 
       detail::function::function_buffer type_result;
       type_result.members.type.type = &boost::typeindex::type_id<Functor>().type_info();
+      type_result.members.type.identity =
+        &detail::function::functor_identity<typename remove_cv<Functor>::type>::id;
       type_result.members.type.const_qualified = true;
       type_result.members.type.volatile_qualified = is_volatile<Functor>::value;
-      get_vtable()->manager(functor, type_result,
+      get_vtable()->manager(get_functor_buffer(), type_result,
                       detail::function::check_functor_type_tag);
       // GCC 2.95.3 gets the CV qualifiers wrong here, so we
       // can't do the static_cast that we should do.
@@ -683,15 +1470,214 @@ public:
 public: // should be protected, but GCC 2.95.3 will fail to allow access
   detail::function::vtable_base* get_vtable() const {
     return reinterpret_cast<detail::function::vtable_base*>(
-             reinterpret_cast<std::size_t>(vtable) & ~static_cast<std::size_t>(0x01));
+             reinterpret_cast<std::size_t>(vtable) & ~static_cast<std::size_t>(0x0f));
   }
 
   bool has_trivial_copy_and_destroy() const {
     return reinterpret_cast<std::size_t>(vtable) & 0x01;
   }
 
+  // Whether the target can be moved with a memcpy of the buffer
+  bool has_trivial_relocation() const {
+    return (reinterpret_cast<std::size_t>(vtable) & 0x02) != 0;
+  }
+
+  // Whether the target is stored in the buffer rather than on the heap
+  bool has_inline_target() const {
+    return (reinterpret_cast<std::size_t>(vtable) & 0x08) != 0;
+  }
+
+  detail::function::function_buffer& get_functor_buffer() const {
+    return detail::function::get_function_buffer(functor);
+  }
+
+  // Whether the vtable identifies the target as a Functor, in which case
+  // known_target() finds it without calling the manager
+  template<typename Functor>
+  bool has_identity() const {
+    typedef typename remove_cv<Functor>::type functor_type;
+    typedef typename detail::function::identity_type<functor_type>::type identity;
+    return !is_void<identity>::value &&
+      get_vtable()->identity == &detail::function::functor_identity<identity>::id;
+  }
+
+  // Whether the vtable identifies its target at all
+  bool has_unique_identity() const {
+    return get_vtable()->identity != &detail::function::functor_identity<void>::id;
+  }
+
+  template<typename Functor>
+  void* known_target() const {
+    typedef typename remove_cv<Functor>::type functor_type;
+    typedef typename detail::function::get_function_tag<functor_type>::type tag;
+    return target_address<functor_type>(tag());
+  }
+
+  template<typename Functor>
+  void* target_address(detail::function::function_ptr_tag) const {
+    return &get_functor_buffer().members.func_ptr;
+  }
+
+  template<typename Functor>
+  void* target_address(detail::function::function_obj_tag) const {
+    if (has_inline_target())
+      return get_functor_buffer().data;
+    else
+      return get_functor_buffer().members.obj_ptr;
+  }
+
+  // Other targets have no identity
+  template<typename Functor, typename Tag>
+  void* target_address(Tag) const { return 0; }
+
+  // Copy and exchange the cached invokers along with the vtables
+  void copy_invoker(const basic_function_base& f) {
+#ifdef BOOST_FUNCTION_CACHE_INVOKER
+    invoker = f.invoker;
+#else
+    (void)f;
+#endif
+  }
+
+  void swap_invoker(basic_function_base& f) {
+#ifdef BOOST_FUNCTION_CACHE_INVOKER
+    detail::function::generic_invoker i = invoker;
+    invoker = f.invoker;
+    f.invoker = i;
+#else
+    (void)f;
+#endif
+  }
+
   detail::function::vtable_base* vtable;
-  mutable detail::function::function_buffer functor;
+#ifdef BOOST_FUNCTION_CACHE_INVOKER
+  // A copy of the invoker of the vtable. Empty functions point at the
+  // empty vtable, so this is then its invoker, which throws
+  // bad_function_call.
+  detail::function::generic_invoker invoker;
+#endif
+  mutable Storage functor;
+};
+
+/**
+ * The base class of the functions using the default small-object buffer,
+ * such as boost::function. Functions with another buffer, such as
+ * basic_function with a non-default capacity, derive from their
+ * basic_function_base instance directly.
+ */
+class function_base : public basic_function_base<detail::function::function_buffer>
+{
+};
+
+namespace detail {
+  namespace function {
+    // The base class of the functions storing their targets in Storage
+    template<typename Storage>
+    struct function_base_type
+    {
+      typedef basic_function_base<Storage> type;
+    };
+
+    template<>
+    struct function_base_type<function_buffer>
+    {
+      typedef boost::function_base type;
+    };
+  } // end namespace function
+} // end namespace detail
+
+/**
+ * A pointer to a member function bound to an object. The function
+ * classes keep it in the bound_memfunc_ptr member of their buffer, copy
+ * it with a memcpy and call (object->*member)(args...) directly, without
+ * going through mem_fn or bind. The object is not owned. Create one with
+ * make_delegate.
+ */
+template<typename T, typename MemberPtr>
+class delegate
+{
+  BOOST_STATIC_ASSERT_MSG(is_member_function_pointer<MemberPtr>::value,
+                          "delegate requires a pointer to a member function");
+
+  typedef detail::function::function_buffer_members::bound_memfunc_ptr_t
+    bound_type;
+
+  // The member pointer is kept in memfunc_ptr, whose class is incomplete
+  // so that it is as large as any member pointer can be. It is copied
+  // bytewise rather than cast between unrelated member pointer types.
+  BOOST_STATIC_ASSERT(sizeof(MemberPtr) <=
+                      sizeof(static_cast<bound_type*>(0)->memfunc_ptr));
+
+public:
+  delegate(T* object, MemberPtr member)
+  {
+    bound.memfunc_ptr = 0;
+    std::memcpy(&bound.memfunc_ptr, &member, sizeof(MemberPtr));
+    bound.obj_ptr =
+      const_cast<void*>(static_cast<const volatile void*>(object));
+  }
+
+  T* object() const { return static_cast<T*>(bound.obj_ptr); }
+
+  MemberPtr member() const
+  {
+    MemberPtr member;
+    std::memcpy(&member, &bound.memfunc_ptr, sizeof(MemberPtr));
+    return member;
+  }
+
+private:
+  bound_type bound;
+};
+
+template<typename T, typename MemberPtr>
+inline delegate<T, MemberPtr> make_delegate(T* object, MemberPtr member)
+{
+  return delegate<T, MemberPtr>(object, member);
+}
+
+/**
+ * Hashes functions by their target, for use as keys of unordered
+ * containers together with function_identity_equal. Function pointers
+ * and member pointers hash by value, delegates by object and member,
+ * references by the address of the referenced object, and function
+ * objects with is_hashable_target by their hash_value(). Functions with
+ * other targets hash by their vtable.
+ */
+struct function_hash
+{
+  template<typename Storage>
+  std::size_t operator()(const basic_function_base<Storage>& f) const
+  {
+    detail::function::vtable_base* vtable = f.get_vtable();
+    if (vtable->hash)
+      return vtable->hash(f.get_functor_buffer());
+    else
+      return reinterpret_cast<std::size_t>(vtable);
+  }
+};
+
+/**
+ * Whether two functions hold equal targets of the same type, stored the
+ * same way, as hashed by function_hash. Empty functions are equal to each
+ * other. A function whose target function_hash cannot hash is only equal
+ * to itself, not to its copies, which keeps the relation an equivalence
+ * for unordered containers. As with target(), functions built in
+ * different shared libraries are only recognized as equal when the
+ * dynamic linker merges their vtables.
+ */
+struct function_identity_equal
+{
+  template<typename Storage>
+  bool operator()(const basic_function_base<Storage>& f,
+                  const basic_function_base<Storage>& g) const
+  {
+    detail::function::vtable_base* vtable = f.get_vtable();
+    if (!vtable->equal)
+      return &f == &g;
+    return vtable->equal == g.get_vtable()->equal &&
+      vtable->equal(f.get_functor_buffer(), g.get_functor_buffer());
+  }
 };
 
 #if defined(BOOST_CLANG)
@@ -712,26 +1698,30 @@ public:
 #endif
 
 #ifndef BOOST_NO_SFINAE
-inline bool operator==(const function_base& f,
+template<typename Storage>
+inline bool operator==(const basic_function_base<Storage>& f,
                        detail::function::useless_clear_type*)
 {
   return f.empty();
 }
 
-inline bool operator!=(const function_base& f,
+template<typename Storage>
+inline bool operator!=(const basic_function_base<Storage>& f,
                        detail::function::useless_clear_type*)
 {
   return !f.empty();
 }
 
+template<typename Storage>
 inline bool operator==(detail::function::useless_clear_type*,
-                       const function_base& f)
+                       const basic_function_base<Storage>& f)
 {
   return f.empty();
 }
 
+template<typename Storage>
 inline bool operator!=(detail::function::useless_clear_type*,
-                       const function_base& f)
+                       const basic_function_base<Storage>& f)
 {
   return !f.empty();
 }
@@ -739,29 +1729,29 @@ inline bool operator!=(detail::function::useless_clear_type*,
 
 #ifdef BOOST_NO_SFINAE
 // Comparisons between boost::function objects and arbitrary function objects
-template<typename Functor>
-  inline bool operator==(const function_base& f, Functor g)
+template<typename Storage, typename Functor>
+  inline bool operator==(const basic_function_base<Storage>& f, Functor g)
   {
     typedef integral_constant<bool, (is_integral<Functor>::value)> integral;
     return detail::function::compare_equal(f, g, 0, integral());
   }
 
-template<typename Functor>
-  inline bool operator==(Functor g, const function_base& f)
+template<typename Storage, typename Functor>
+  inline bool operator==(Functor g, const basic_function_base<Storage>& f)
   {
     typedef integral_constant<bool, (is_integral<Functor>::value)> integral;
     return detail::function::compare_equal(f, g, 0, integral());
   }
 
-template<typename Functor>
-  inline bool operator!=(const function_base& f, Functor g)
+template<typename Storage, typename Functor>
+  inline bool operator!=(const basic_function_base<Storage>& f, Functor g)
   {
     typedef integral_constant<bool, (is_integral<Functor>::value)> integral;
     return detail::function::compare_not_equal(f, g, 0, integral());
   }
 
-template<typename Functor>
-  inline bool operator!=(Functor g, const function_base& f)
+template<typename Storage, typename Functor>
+  inline bool operator!=(Functor g, const basic_function_base<Storage>& f)
   {
     typedef integral_constant<bool, (is_integral<Functor>::value)> integral;
     return detail::function::compare_not_equal(f, g, 0, integral());
@@ -772,36 +1762,36 @@ template<typename Functor>
 // Comparisons between boost::function objects and arbitrary function
 // objects. GCC 3.3 and before has an obnoxious bug that prevents this
 // from working.
-template<typename Functor>
+template<typename Storage, typename Functor>
   BOOST_FUNCTION_ENABLE_IF_NOT_INTEGRAL(Functor, bool)
-  operator==(const function_base& f, Functor g)
+  operator==(const basic_function_base<Storage>& f, Functor g)
   {
     if (const Functor* fp = f.template target<Functor>())
       return function_equal(*fp, g);
     else return false;
   }
 
-template<typename Functor>
+template<typename Storage, typename Functor>
   BOOST_FUNCTION_ENABLE_IF_NOT_INTEGRAL(Functor, bool)
-  operator==(Functor g, const function_base& f)
+  operator==(Functor g, const basic_function_base<Storage>& f)
   {
     if (const Functor* fp = f.template target<Functor>())
       return function_equal(g, *fp);
     else return false;
   }
 
-template<typename Functor>
+template<typename Storage, typename Functor>
   BOOST_FUNCTION_ENABLE_IF_NOT_INTEGRAL(Functor, bool)
-  operator!=(const function_base& f, Functor g)
+  operator!=(const basic_function_base<Storage>& f, Functor g)
   {
     if (const Functor* fp = f.template target<Functor>())
       return !function_equal(*fp, g);
     else return true;
   }
 
-template<typename Functor>
+template<typename Storage, typename Functor>
   BOOST_FUNCTION_ENABLE_IF_NOT_INTEGRAL(Functor, bool)
-  operator!=(Functor g, const function_base& f)
+  operator!=(Functor g, const basic_function_base<Storage>& f)
   {
     if (const Functor* fp = f.template target<Functor>())
       return !function_equal(g, *fp);
@@ -809,36 +1799,36 @@ template<typename Functor>
   }
 #  endif
 
-template<typename Functor>
+template<typename Storage, typename Functor>
   BOOST_FUNCTION_ENABLE_IF_NOT_INTEGRAL(Functor, bool)
-  operator==(const function_base& f, reference_wrapper<Functor> g)
+  operator==(const basic_function_base<Storage>& f, reference_wrapper<Functor> g)
   {
     if (const Functor* fp = f.template target<Functor>())
       return fp == g.get_pointer();
     else return false;
   }
 
-template<typename Functor>
+template<typename Storage, typename Functor>
   BOOST_FUNCTION_ENABLE_IF_NOT_INTEGRAL(Functor, bool)
-  operator==(reference_wrapper<Functor> g, const function_base& f)
+  operator==(reference_wrapper<Functor> g, const basic_function_base<Storage>& f)
   {
     if (const Functor* fp = f.template target<Functor>())
       return g.get_pointer() == fp;
     else return false;
   }
 
-template<typename Functor>
+template<typename Storage, typename Functor>
   BOOST_FUNCTION_ENABLE_IF_NOT_INTEGRAL(Functor, bool)
-  operator!=(const function_base& f, reference_wrapper<Functor> g)
+  operator!=(const basic_function_base<Storage>& f, reference_wrapper<Functor> g)
   {
     if (const Functor* fp = f.template target<Functor>())
       return fp != g.get_pointer();
     else return true;
   }
 
-template<typename Functor>
+template<typename Storage, typename Functor>
   BOOST_FUNCTION_ENABLE_IF_NOT_INTEGRAL(Functor, bool)
-  operator!=(reference_wrapper<Functor> g, const function_base& f)
+  operator!=(reference_wrapper<Functor> g, const basic_function_base<Storage>& f)
   {
     if (const Functor* fp = f.template target<Functor>())
       return g.get_pointer() != fp;
@@ -849,7 +1839,8 @@ template<typename Functor>
 
 namespace detail {
   namespace function {
-    inline bool has_empty_target(const function_base* f)
+    template<typename Storage>
+    inline bool has_empty_target(const basic_function_base<Storage>* f)
     {
       return f->empty();
     }
@@ -0,0 +1,368 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#ifndef BOOST_FUNCTION_FUNCTION_EXECUTOR_HPP
+#define BOOST_FUNCTION_FUNCTION_EXECUTOR_HPP
+
+#include <boost/function.hpp>
+#include <boost/config.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_HDR_CONDITION_VARIABLE) && \
+    !defined(BOOST_NO_CXX11_HDR_MUTEX) && \
+    !defined(BOOST_NO_CXX11_HDR_THREAD) && \
+    !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace boost {
+  namespace detail {
+    namespace function {
+      /**
+       * A Chase-Lev work-stealing deque of Size tasks, held in place in
+       * a ring of slots rather than behind pointers. The owning worker
+       * pushes and pops at the bottom, other workers steal from the top.
+       * A thief claims a task by advancing the top before moving it out
+       * of its slot, and the slot stays marked full until it has, so the
+       * owner never overwrites a task that is being stolen and thieves
+       * never read a slot they have not claimed. The ring does not grow:
+       * push() fails when it is full.
+       */
+      template<typename Task, std::size_t Size>
+      class task_deque
+      {
+        BOOST_STATIC_ASSERT_MSG((Size & (Size - 1)) == 0, "the size must be a power of two");
+
+      public:
+        task_deque() : top(0), bottom(0) {}
+
+        // Owner only
+        bool push(Task& task)
+        {
+          long long b = bottom.load(std::memory_order_relaxed);
+          long long t = top.load(std::memory_order_acquire);
+          if (b - t >= static_cast<long long>(Size))
+            return false;
+
+          slot& s = slots[b & (Size - 1)];
+          while (s.full.load(std::memory_order_acquire))
+            std::this_thread::yield();
+          s.task = static_cast<Task&&>(task);
+          s.full.store(true, std::memory_order_relaxed);
+          bottom.store(b + 1, std::memory_order_release);
+          return true;
+        }
+
+        // Owner only
+        bool pop(Task& task)
+        {
+          long long b = bottom.load(std::memory_order_relaxed) - 1;
+          bottom.store(b, std::memory_order_seq_cst);
+          long long t = top.load(std::memory_order_seq_cst);
+          if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+          }
+
+          if (t == b) {
+            // The last task, which a thief may be claiming as well
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won)
+              return false;
+          }
+
+          take(slots[b & (Size - 1)], task);
+          return true;
+        }
+
+        bool steal(Task& task)
+        {
+          long long t = top.load(std::memory_order_seq_cst);
+          long long b = bottom.load(std::memory_order_seq_cst);
+          if (t >= b)
+            return false;
+          if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed))
+            return false;
+
+          take(slots[t & (Size - 1)], task);
+          return true;
+        }
+
+        bool empty() const
+        {
+          return bottom.load(std::memory_order_seq_cst) <= top.load(std::memory_order_seq_cst);
+        }
+
+      private:
+        struct slot
+        {
+          slot() : full(false) {}
+
+          Task task;
+          std::atomic<bool> full;
+        };
+
+        static void take(slot& s, Task& task)
+        {
+          task = static_cast<Task&&>(s.task);
+          s.full.store(false, std::memory_order_release);
+        }
+
+        std::atomic<long long> top;
+        // Keeps thieves and the owner on separate cache lines
+        char padding[64];
+        std::atomic<long long> bottom;
+        slot slots[Size];
+      };
+    } // end namespace function
+  } // end namespace detail
+
+/**
+ * A thread pool whose tasks are inplace_function<void(), Capacity>
+ * objects, stored directly in the slots of per-worker Chase-Lev deques,
+ * so that queuing a task allocates nothing. Tasks submitted by a task
+ * go to the deque of its worker, and idle workers steal from the others.
+ * Tasks submitted from other threads go through a shared queue. Function
+ * objects larger than Capacity are wrapped in a boost::function first,
+ * and thus allocated. When the deque of a worker is full, the task is
+ * run at once by the submitting worker.
+ *
+ * Tasks must not throw. The destructor waits for all submitted tasks,
+ * including the ones they submit, before stopping the workers.
+ */
+template<std::size_t Capacity>
+class basic_function_executor
+{
+  BOOST_STATIC_ASSERT_MSG(Capacity >= sizeof(boost::function<void()>),
+                          "tasks must be able to hold a boost::function<void()>");
+
+public:
+  typedef inplace_function<void(), Capacity> task_type;
+
+  // The number of tasks each worker can hold
+  static const std::size_t deque_size = 1024;
+
+  explicit basic_function_executor(std::size_t threads = std::thread::hardware_concurrency())
+    : pending(0), injected_size(0), sleepers(0), stopping(false)
+  {
+    if (threads == 0)
+      threads = 1;
+    for (std::size_t i = 0; i < threads; ++i)
+      workers.push_back(std::unique_ptr<worker>(new worker(i)));
+    for (std::size_t i = 0; i < threads; ++i)
+      workers[i]->thread = std::thread(&basic_function_executor::work, this, workers[i].get());
+  }
+
+  ~basic_function_executor()
+  {
+    wait();
+    {
+      std::lock_guard<std::mutex> lock(idle_mutex);
+      stopping.store(true, std::memory_order_seq_cst);
+    }
+    idle.notify_all();
+    for (std::size_t i = 0; i < workers.size(); ++i)
+      workers[i]->thread.join();
+  }
+
+  std::size_t size() const { return workers.size(); }
+
+  /** Queue f to be called by a worker. */
+  template<typename F>
+  void submit(F&& f)
+  {
+    typedef typename decay<F>::type functor_type;
+    typedef detail::function::function_storage<Capacity, alignment_of<void*>::value>
+      storage_type;
+
+    task_type task(make_task(static_cast<F&&>(f),
+                             integral_constant<bool, (detail::function::is_stored_inline<
+                                                       functor_type, storage_type>::value)>()));
+    if (task.empty())
+      return;
+
+    pending.fetch_add(1, std::memory_order_relaxed);
+    worker* w = this_thread_worker();
+    if (w && w->executor == this) {
+      if (!w->tasks.push(task)) {
+        run(task);
+        return;
+      }
+    } else {
+      std::lock_guard<std::mutex> lock(injected_mutex);
+      injected.push_back(static_cast<task_type&&>(task));
+      injected_size.fetch_add(1, std::memory_order_seq_cst);
+    }
+    wake();
+  }
+
+  /** Wait until every submitted task has returned. Not from a task. */
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(idle_mutex);
+    while (pending.load(std::memory_order_acquire) != 0)
+      done.wait(lock);
+  }
+
+private:
+  basic_function_executor(const basic_function_executor&);
+  basic_function_executor& operator=(const basic_function_executor&);
+
+  struct worker
+  {
+    explicit worker(std::size_t i) : executor(0), index(i), random(static_cast<unsigned>(i) * 2654435761u + 1) {}
+
+    detail::function::task_deque<task_type, deque_size> tasks;
+    basic_function_executor* executor;
+    std::size_t index;
+    unsigned random;
+    std::thread thread;
+  };
+
+  template<typename F>
+  static task_type make_task(F&& f, true_type)
+  {
+    return task_type(static_cast<F&&>(f));
+  }
+
+  template<typename F>
+  static task_type make_task(F&& f, false_type)
+  {
+    return task_type(boost::function<void()>(static_cast<F&&>(f)));
+  }
+
+  static worker*& this_thread_worker()
+  {
+    static thread_local worker* w = 0;
+    return w;
+  }
+
+  void run(task_type& task)
+  {
+    task();
+    task.clear();
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::lock_guard<std::mutex> lock(idle_mutex);
+      done.notify_all();
+    }
+  }
+
+  bool take_injected(task_type& task)
+  {
+    if (injected_size.load(std::memory_order_seq_cst) == 0)
+      return false;
+    std::lock_guard<std::mutex> lock(injected_mutex);
+    if (injected.empty())
+      return false;
+    task = static_cast<task_type&&>(injected.front());
+    injected.pop_front();
+    injected_size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool steal(worker& w, task_type& task)
+  {
+    std::size_t n = workers.size();
+    w.random ^= w.random << 13;
+    w.random ^= w.random >> 17;
+    w.random ^= w.random << 5;
+    std::size_t start = w.random % n;
+    for (std::size_t i = 0; i < n; ++i) {
+      worker& victim = *workers[(start + i) % n];
+      if (&victim != &w && victim.tasks.steal(task))
+        return true;
+    }
+    return false;
+  }
+
+  bool has_work() const
+  {
+    if (injected_size.load(std::memory_order_seq_cst) != 0)
+      return true;
+    for (std::size_t i = 0; i < workers.size(); ++i)
+      if (!workers[i]->tasks.empty())
+        return true;
+    return false;
+  }
+
+  void wake()
+  {
+    if (sleepers.load(std::memory_order_seq_cst) != 0) {
+      std::lock_guard<std::mutex> lock(idle_mutex);
+      idle.notify_one();
+    }
+  }
+
+  void work(worker* w)
+  {
+    w->executor = this;
+    this_thread_worker() = w;
+
+    task_type task;
+    unsigned spins = 0;
+    for (;;) {
+      if (w->tasks.pop(task) || take_injected(task) || steal(*w, task)) {
+        run(task);
+        spins = 0;
+        continue;
+      }
+
+      if (stopping.load(std::memory_order_acquire))
+        return;
+
+      if (++spins < 64) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      // The sleeper count is raised before looking for work, so that
+      // a submitter either finds it raised or its task is found here
+      std::unique_lock<std::mutex> lock(idle_mutex);
+      sleepers.fetch_add(1, std::memory_order_seq_cst);
+      if (!has_work() && !stopping.load(std::memory_order_seq_cst))
+        idle.wait_for(lock, std::chrono::milliseconds(10));
+      sleepers.fetch_sub(1, std::memory_order_relaxed);
+      spins = 0;
+    }
+  }
+
+  std::vector<std::unique_ptr<worker> > workers;
+  std::atomic<std::size_t> pending;
+
+  std::mutex injected_mutex;
+  std::deque<task_type> injected;
+  std::atomic<std::size_t> injected_size;
+
+  std::mutex idle_mutex;
+  std::condition_variable idle;
+  std::condition_variable done;
+  std::atomic<unsigned> sleepers;
+  std::atomic<bool> stopping;
+};
+
+template<std::size_t Capacity>
+const std::size_t basic_function_executor<Capacity>::deque_size;
+
+typedef basic_function_executor<64> function_executor;
+
+} // end namespace boost
+
+#endif
+
+#endif // BOOST_FUNCTION_FUNCTION_EXECUTOR_HPP
@@ -9,6 +9,8 @@
 #ifndef BOOST_FUNCTION_FWD_HPP
 #define BOOST_FUNCTION_FWD_HPP
 #include <boost/config.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <cstddef>
 
 #if defined(__sgi) && defined(_COMPILER_VERSION) && _COMPILER_VERSION <= 730 && !defined(BOOST_STRICT_CONFIG)
 // Work around a compiler bug.
@@ -27,15 +29,62 @@ namespace boost { namespace python { namespace objects {
 namespace boost {
   class bad_function_call;
 
+  template<typename T, typename MemberPtr> class delegate;
+
+  namespace detail {
+    namespace function {
+      union function_buffer;
+    }
+  }
+
 #if !defined(BOOST_FUNCTION_NO_FUNCTION_TYPE_SYNTAX)
   // Preferred syntax
   template<typename Signature> class function;
 
   template<typename Signature>
-  inline void swap(function<Signature>& f1, function<Signature>& f2)
+  inline void swap(function<Signature>& f1, function<Signature>& f2) BOOST_NOEXCEPT
   {
     f1.swap(f2);
   }
+
+  // Function with a user-chosen small-object buffer
+  template<typename Signature, std::size_t Capacity,
+           std::size_t Alignment = alignment_of<void*>::value>
+    class basic_function;
+
+  template<typename Signature, std::size_t Capacity, std::size_t Alignment>
+  inline void swap(basic_function<Signature, Capacity, Alignment>& f1,
+                   basic_function<Signature, Capacity, Alignment>& f2) BOOST_NOEXCEPT
+  {
+    f1.swap(f2);
+  }
+
+  // Function that stores its target inline or fails to compile
+  template<typename Signature, std::size_t Capacity,
+           std::size_t Alignment = alignment_of<void*>::value>
+    class inplace_function;
+
+  template<typename Signature, std::size_t Capacity, std::size_t Alignment>
+  inline void swap(inplace_function<Signature, Capacity, Alignment>& f1,
+                   inplace_function<Signature, Capacity, Alignment>& f2) BOOST_NOEXCEPT
+  {
+    f1.swap(f2);
+  }
+
+  // Non-owning reference to a callable
+  template<typename Signature> class function_ref;
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  // Move-only function, for move-only targets
+  template<typename Signature> class unique_function;
+
+  template<typename Signature>
+  inline void swap(unique_function<Signature>& f1,
+                   unique_function<Signature>& f2) BOOST_NOEXCEPT
+  {
+    f1.swap(f2);
+  }
+#endif
 #endif // have partial specialization
 
   // Portable syntax
@@ -0,0 +1,206 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#ifndef BOOST_FUNCTION_FUNCTION_LIST_HPP
+#define BOOST_FUNCTION_FUNCTION_LIST_HPP
+
+#include <boost/function.hpp>
+#include <boost/function/detail/epoch_domain.hpp>
+#include <boost/config.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_HDR_MUTEX) && \
+    !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) && \
+    !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace boost {
+
+template<typename Signature> class function_list;
+
+/**
+ * A list of boost::function objects that are all called by a single
+ * call, as for signals and observers. The functions are kept in an
+ * immutable snapshot, an array holding them contiguously. Calls and
+ * for_each() read the current snapshot without locking and without
+ * copying it, and are wait-free. connect() and disconnect() build a new
+ * snapshot under a mutex, copying the functions of the old one, publish
+ * it and retire the old one, which is destroyed once no call can still
+ * be iterating over it. A call that started before a connect() or a
+ * disconnect() does not see it.
+ *
+ * Connecting and disconnecting thus costs a copy of every function, a
+ * memcpy for function objects stored inline with the trivial copy tag,
+ * in exchange for calls that never copy nor lock.
+ */
+template<typename R, typename... Args>
+class function_list<R(Args...)>
+{
+public:
+  typedef boost::function<R(Args...)> function_type;
+  typedef void result_type;
+
+  // Identifies a connected function, never 0
+  typedef unsigned long long connection;
+
+  function_list() BOOST_NOEXCEPT : current(0), next_connection(0) {}
+
+  ~function_list() { delete current.load(std::memory_order_relaxed); }
+
+  /** Add f at the end of the list. Returns 0 if f is empty. */
+  connection connect(function_type f)
+  {
+    if (f.empty())
+      return 0;
+
+    snapshot* old;
+    connection c;
+    {
+      std::lock_guard<std::mutex> lock(writer);
+      old = current.load(std::memory_order_relaxed);
+
+      std::unique_ptr<snapshot> s(new snapshot);
+      if (old) {
+        s->entries.reserve(old->entries.size() + 1);
+        s->entries.insert(s->entries.end(), old->entries.begin(), old->entries.end());
+      }
+      c = next_connection + 1;
+      s->entries.push_back(entry(c, static_cast<function_type&&>(f)));
+      next_connection = c;
+      current.store(s.release(), std::memory_order_seq_cst);
+    }
+    retire(old);
+    return c;
+  }
+
+  /** Remove the function connected as c. Returns false if none was. */
+  bool disconnect(connection c)
+  {
+    snapshot* old;
+    {
+      std::lock_guard<std::mutex> lock(writer);
+      old = current.load(std::memory_order_relaxed);
+      if (!old)
+        return false;
+
+      std::size_t i = 0;
+      std::size_t size = old->entries.size();
+      while (i < size && old->entries[i].id != c)
+        ++i;
+      if (i == size)
+        return false;
+
+      std::unique_ptr<snapshot> s;
+      if (size > 1) {
+        s.reset(new snapshot);
+        s->entries.reserve(size - 1);
+        s->entries.insert(s->entries.end(), old->entries.begin(), old->entries.begin() + i);
+        s->entries.insert(s->entries.end(), old->entries.begin() + i + 1, old->entries.end());
+      }
+      current.store(s.release(), std::memory_order_seq_cst);
+    }
+    retire(old);
+    return true;
+  }
+
+  /** Remove all functions. */
+  void clear()
+  {
+    snapshot* old;
+    {
+      std::lock_guard<std::mutex> lock(writer);
+      old = current.exchange(0, std::memory_order_seq_cst);
+    }
+    retire(old);
+  }
+
+  bool empty() const BOOST_NOEXCEPT
+  {
+    return current.load(std::memory_order_acquire) == 0;
+  }
+
+  /** The number of functions in the current snapshot. */
+  std::size_t size() const
+  {
+    detail::function::epoch_domain::guard guard;
+    snapshot* s = current.load(std::memory_order_seq_cst);
+    return s ? s->entries.size() : 0;
+  }
+
+  /** Call every function of the current snapshot, in connection order. */
+  void operator()(Args... args) const
+  {
+    detail::function::epoch_domain::guard guard;
+    if (snapshot* s = current.load(std::memory_order_seq_cst)) {
+      const entry* e = s->entries.data();
+      const entry* end = e + s->entries.size();
+      for (; e != end; ++e)
+        e->f(args...);
+    }
+  }
+
+  /** Pass every function of the current snapshot to visit. */
+  template<typename Visitor>
+  void for_each(Visitor visit) const
+  {
+    detail::function::epoch_domain::guard guard;
+    if (snapshot* s = current.load(std::memory_order_seq_cst)) {
+      const entry* e = s->entries.data();
+      const entry* end = e + s->entries.size();
+      for (; e != end; ++e)
+        visit(e->f);
+    }
+  }
+
+private:
+  function_list(const function_list&);
+  function_list& operator=(const function_list&);
+
+  struct entry
+  {
+    entry(connection c, function_type&& target)
+      : f(static_cast<function_type&&>(target)), id(c) {}
+
+    function_type f;
+    connection id;
+  };
+
+  struct snapshot : detail::function::epoch_domain::retired
+  {
+    snapshot() { destroy = &destroy_snapshot; }
+
+    std::vector<entry> entries;
+  };
+
+  static void destroy_snapshot(detail::function::epoch_domain::retired* s)
+  {
+    delete static_cast<snapshot*>(s);
+  }
+
+  // Outside of the writer lock, as it may run destructors of targets
+  static void retire(snapshot* old)
+  {
+    if (old)
+      detail::function::epoch_domain::instance().retire(old);
+  }
+
+  std::atomic<snapshot*> current;
+  std::mutex writer;
+  connection next_connection;
+};
+
+} // end namespace boost
+
+#endif
+
+#endif // BOOST_FUNCTION_FUNCTION_LIST_HPP
@@ -0,0 +1,90 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#ifndef BOOST_FUNCTION_FUNCTION_POOL_ALLOCATOR_HPP
+#define BOOST_FUNCTION_FUNCTION_POOL_ALLOCATOR_HPP
+
+#include <boost/function/detail/size_class_pool.hpp>
+#include <boost/config.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <cstddef>
+#include <new>
+
+namespace boost {
+
+/**
+ * A stateless allocator drawing from the per-thread size-class pools
+ * that BOOST_FUNCTION_POOLED_ALLOCATION enables for every function. Pass
+ * it to the allocator constructors and assign() of boost::function to
+ * pool the function objects of selected functions only:
+ *
+ *   boost::function<void()> f(callback, boost::function_pool_allocator<int>());
+ *
+ * Memory allocated in a thread may be freed in any other one.
+ */
+template<typename T>
+class function_pool_allocator
+{
+  BOOST_STATIC_ASSERT_MSG(alignment_of<T>::value <= alignment_of<boost::detail::max_align>::value,
+                          "over-aligned types cannot be pooled");
+
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template<typename U>
+  struct rebind
+  {
+    typedef function_pool_allocator<U> other;
+  };
+
+  function_pool_allocator() BOOST_NOEXCEPT {}
+
+  template<typename U>
+  function_pool_allocator(const function_pool_allocator<U>&) BOOST_NOEXCEPT {}
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(detail::function::size_class_pool::allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) BOOST_NOEXCEPT
+  {
+    detail::function::size_class_pool::deallocate(p, n * sizeof(T));
+  }
+
+  void construct(T* p, const T& value) { new (p) T(value); }
+  void destroy(T* p) { p->~T(); }
+};
+
+template<typename T, typename U>
+inline bool operator==(const function_pool_allocator<T>&, const function_pool_allocator<U>&)
+{
+  return true;
+}
+
+template<typename T, typename U>
+inline bool operator!=(const function_pool_allocator<T>&, const function_pool_allocator<U>&)
+{
+  return false;
+}
+
+} // end namespace boost
+
+#endif
+
+#endif // BOOST_FUNCTION_FUNCTION_POOL_ALLOCATOR_HPP
@@ -0,0 +1,212 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#ifndef BOOST_FUNCTION_FUNCTION_RING_HPP
+#define BOOST_FUNCTION_FUNCTION_RING_HPP
+
+#include <boost/function.hpp>
+#include <boost/config.hpp>
+#include <boost/core/no_exceptions_support.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) && \
+    !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace boost {
+
+template<typename Signature, std::size_t Slots, std::size_t InlineBytes = 64>
+class function_ring;
+
+/**
+ * A bounded lock-free queue of functions, for any number of producers
+ * and consumers. Each of the Slots slots, a cache line or more, holds an
+ * inplace_function<R(Args...), InlineBytes>: a producer constructs it
+ * from the function object directly in the slot it claimed, and a
+ * consumer calls it and destroys it there, so that nothing is allocated
+ * nor moved between them. Function objects that do not fit in
+ * InlineBytes do not compile; a boost::function can be pushed instead.
+ *
+ * Slots are claimed in order through a sequence number per slot, after
+ * Dmitry Vyukov's bounded MPMC queue: a producer or a consumer waits
+ * only for the one that claimed the same slot a lap earlier.
+ */
+template<typename R, typename... Args, std::size_t Slots, std::size_t InlineBytes>
+class function_ring<R(Args...), Slots, InlineBytes>
+{
+  BOOST_STATIC_ASSERT_MSG(Slots >= 2 && (Slots & (Slots - 1)) == 0,
+                          "the number of slots must be a power of two");
+
+public:
+  typedef inplace_function<R(Args...), InlineBytes> function_type;
+  typedef void result_type;
+
+  function_ring() BOOST_NOEXCEPT : head(0), tail(0)
+  {
+    for (std::size_t i = 0; i < Slots; ++i)
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  ~function_ring()
+  {
+    std::size_t pos;
+    while (slot* s = claim_front(pos))
+      release(*s, pos);
+  }
+
+  std::size_t capacity() const BOOST_NOEXCEPT { return Slots; }
+
+  /** The number of queued functions, which may already have changed. */
+  std::size_t size() const BOOST_NOEXCEPT
+  {
+    std::size_t h = head.load(std::memory_order_acquire);
+    std::size_t t = tail.load(std::memory_order_acquire);
+    return t > h ? t - h : 0;
+  }
+
+  bool empty() const BOOST_NOEXCEPT { return size() == 0; }
+
+  /**
+   * Queue f, constructed in a slot. Returns false if the ring is full.
+   * If constructing the function throws, the slot is left empty and
+   * consumers skip it.
+   */
+  template<typename F>
+  bool try_push(F&& f)
+  {
+    std::size_t pos = tail.load(std::memory_order_relaxed);
+    slot* s;
+    for (;;) {
+      s = &slots[pos & (Slots - 1)];
+      std::size_t seq = s->sequence.load(std::memory_order_acquire);
+      std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - pos);
+      if (diff == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    BOOST_TRY {
+      new (s->address()) function_type(static_cast<F&&>(f));
+    } BOOST_CATCH(...) {
+      new (s->address()) function_type();
+      s->sequence.store(pos + 1, std::memory_order_release);
+      BOOST_RETHROW;
+    }
+    BOOST_CATCH_END
+    s->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Call the oldest function with args and destroy it, in its slot.
+   * Returns false if the ring is empty. Empty functions are skipped.
+   * The result of the function is discarded.
+   */
+  bool try_call(Args... args)
+  {
+    for (;;) {
+      std::size_t pos;
+      slot* s = claim_front(pos);
+      if (!s)
+        return false;
+
+      releaser r(*s, pos);
+      function_type& f = s->function();
+      if (!f.empty()) {
+        f(static_cast<Args&&>(args)...);
+        return true;
+      }
+    }
+  }
+
+  /** Move the oldest function out to f. Returns false if the ring is empty. */
+  bool try_pop(function_type& f)
+  {
+    for (;;) {
+      std::size_t pos;
+      slot* s = claim_front(pos);
+      if (!s)
+        return false;
+
+      releaser r(*s, pos);
+      if (!s->function().empty()) {
+        f = static_cast<function_type&&>(s->function());
+        return true;
+      }
+    }
+  }
+
+private:
+  function_ring(const function_ring&);
+  function_ring& operator=(const function_ring&);
+
+  struct BOOST_ALIGNMENT(64) slot
+  {
+    void* address() { return &storage; }
+    function_type& function() { return *static_cast<function_type*>(address()); }
+
+    std::atomic<std::size_t> sequence;
+    typename aligned_storage<sizeof(function_type),
+                             alignment_of<function_type>::value>::type storage;
+  };
+
+  // Destroys the function of a claimed slot and hands the slot back to
+  // producers, even if the call throws
+  struct releaser
+  {
+    releaser(slot& claimed, std::size_t p) : s(claimed), pos(p) {}
+    ~releaser() { release(s, pos); }
+
+    slot& s;
+    std::size_t pos;
+  };
+
+  // Claims the oldest published slot, or returns 0 if there is none
+  slot* claim_front(std::size_t& pos)
+  {
+    pos = head.load(std::memory_order_relaxed);
+    for (;;) {
+      slot* s = &slots[pos & (Slots - 1)];
+      std::size_t seq = s->sequence.load(std::memory_order_acquire);
+      std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+      if (diff == 0) {
+        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          return s;
+      } else if (diff < 0) {
+        return 0;
+      } else {
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  static void release(slot& s, std::size_t pos)
+  {
+    s.function().~function_type();
+    s.sequence.store(pos + Slots, std::memory_order_release);
+  }
+
+  // Consumers and producers on separate cache lines
+  BOOST_ALIGNMENT(64) std::atomic<std::size_t> head;
+  BOOST_ALIGNMENT(64) std::atomic<std::size_t> tail;
+  slot slots[Slots];
+};
+
+} // end namespace boost
+
+#endif
+
+#endif // BOOST_FUNCTION_FUNCTION_RING_HPP
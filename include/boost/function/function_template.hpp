@@ -47,6 +47,10 @@
 
 // Class names used in this version of the code
 #define BOOST_FUNCTION_FUNCTION BOOST_JOIN(function,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_UNIQUE_FUNCTION BOOST_JOIN(unique_function,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_FUNCTION_REF BOOST_JOIN(function_ref,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_FUNCTION_IMPL BOOST_JOIN(function_impl,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_BASIC_FUNCTION BOOST_JOIN(basic_function,BOOST_FUNCTION_NUM_ARGS)
 #define BOOST_FUNCTION_FUNCTION_INVOKER \
   BOOST_JOIN(function_invoker,BOOST_FUNCTION_NUM_ARGS)
 #define BOOST_FUNCTION_VOID_FUNCTION_INVOKER \
@@ -59,10 +63,28 @@
   BOOST_JOIN(function_ref_invoker,BOOST_FUNCTION_NUM_ARGS)
 #define BOOST_FUNCTION_VOID_FUNCTION_REF_INVOKER \
   BOOST_JOIN(void_function_ref_invoker,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_REF_FUNCTION_INVOKER \
+  BOOST_JOIN(function_ref_function_invoker,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_VOID_REF_FUNCTION_INVOKER \
+  BOOST_JOIN(void_function_ref_function_invoker,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_REF_OBJ_INVOKER \
+  BOOST_JOIN(function_ref_obj_invoker,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_VOID_REF_OBJ_INVOKER \
+  BOOST_JOIN(void_function_ref_obj_invoker,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_REF_MEMBER_INVOKER \
+  BOOST_JOIN(function_ref_mem_invoker,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_VOID_REF_MEMBER_INVOKER \
+  BOOST_JOIN(void_function_ref_mem_invoker,BOOST_FUNCTION_NUM_ARGS)
 #define BOOST_FUNCTION_MEMBER_INVOKER \
   BOOST_JOIN(function_mem_invoker,BOOST_FUNCTION_NUM_ARGS)
 #define BOOST_FUNCTION_VOID_MEMBER_INVOKER \
   BOOST_JOIN(function_void_mem_invoker,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_DELEGATE_INVOKER \
+  BOOST_JOIN(function_delegate_invoker,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_VOID_DELEGATE_INVOKER \
+  BOOST_JOIN(function_void_delegate_invoker,BOOST_FUNCTION_NUM_ARGS)
+#define BOOST_FUNCTION_GET_DELEGATE_INVOKER \
+  BOOST_JOIN(get_delegate_invoker,BOOST_FUNCTION_NUM_ARGS)
 #define BOOST_FUNCTION_GET_FUNCTION_INVOKER \
   BOOST_JOIN(get_function_invoker,BOOST_FUNCTION_NUM_ARGS)
 #define BOOST_FUNCTION_GET_FUNCTION_OBJ_INVOKER \
@@ -120,6 +142,7 @@ namespace boost {
 
       template<
         typename FunctionObj,
+        bool SmallObject,
         typename R BOOST_FUNCTION_COMMA
         BOOST_FUNCTION_TEMPLATE_PARMS
       >
@@ -130,7 +153,7 @@ namespace boost {
 
         {
           FunctionObj* f;
-          if (function_allows_small_object_optimization<FunctionObj>::value)
+          if (SmallObject)
             f = reinterpret_cast<FunctionObj*>(function_obj_ptr.data);
           else
             f = reinterpret_cast<FunctionObj*>(function_obj_ptr.members.obj_ptr);
@@ -140,6 +163,7 @@ namespace boost {
 
       template<
         typename FunctionObj,
+        bool SmallObject,
         typename R BOOST_FUNCTION_COMMA
         BOOST_FUNCTION_TEMPLATE_PARMS
       >
@@ -151,7 +175,7 @@ namespace boost {
 
         {
           FunctionObj* f;
-          if (function_allows_small_object_optimization<FunctionObj>::value)
+          if (SmallObject)
             f = reinterpret_cast<FunctionObj*>(function_obj_ptr.data);
           else
             f = reinterpret_cast<FunctionObj*>(function_obj_ptr.members.obj_ptr);
@@ -194,6 +218,145 @@ namespace boost {
         }
       };
 
+      /* Handle invocation through a boost::function_ref, which passes
+         its target by value instead of a function_buffer. */
+      template<
+        typename FunctionPtr,
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS
+      >
+      struct BOOST_FUNCTION_REF_FUNCTION_INVOKER
+      {
+        static R invoke(function_ref_target target BOOST_FUNCTION_COMMA
+                        BOOST_FUNCTION_PARMS)
+
+        {
+          FunctionPtr f = reinterpret_cast<FunctionPtr>(target.func_ptr);
+          return f(BOOST_FUNCTION_ARGS);
+        }
+      };
+
+      template<
+        typename FunctionPtr,
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS
+      >
+      struct BOOST_FUNCTION_VOID_REF_FUNCTION_INVOKER
+      {
+        static BOOST_FUNCTION_VOID_RETURN_TYPE
+        invoke(function_ref_target target BOOST_FUNCTION_COMMA
+               BOOST_FUNCTION_PARMS)
+
+        {
+          FunctionPtr f = reinterpret_cast<FunctionPtr>(target.func_ptr);
+          BOOST_FUNCTION_RETURN(f(BOOST_FUNCTION_ARGS));
+        }
+      };
+
+      template<
+        typename FunctionObj,
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS
+      >
+      struct BOOST_FUNCTION_REF_OBJ_INVOKER
+      {
+        static R invoke(function_ref_target target BOOST_FUNCTION_COMMA
+                        BOOST_FUNCTION_PARMS)
+
+        {
+          FunctionObj* f = static_cast<FunctionObj*>(target.obj_ptr);
+          return (*f)(BOOST_FUNCTION_ARGS);
+        }
+      };
+
+      template<
+        typename FunctionObj,
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS
+      >
+      struct BOOST_FUNCTION_VOID_REF_OBJ_INVOKER
+      {
+        static BOOST_FUNCTION_VOID_RETURN_TYPE
+        invoke(function_ref_target target BOOST_FUNCTION_COMMA
+               BOOST_FUNCTION_PARMS)
+
+        {
+          FunctionObj* f = static_cast<FunctionObj*>(target.obj_ptr);
+          BOOST_FUNCTION_RETURN((*f)(BOOST_FUNCTION_ARGS));
+        }
+      };
+
+#if BOOST_FUNCTION_NUM_ARGS > 0
+      template<
+        typename MemberPtr,
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS
+      >
+      struct BOOST_FUNCTION_REF_MEMBER_INVOKER
+      {
+        static R invoke(function_ref_target target BOOST_FUNCTION_COMMA
+                        BOOST_FUNCTION_PARMS)
+
+        {
+          const MemberPtr* f = static_cast<const MemberPtr*>(target.obj_ptr);
+          return boost::mem_fn(*f)(BOOST_FUNCTION_ARGS);
+        }
+      };
+
+      template<
+        typename MemberPtr,
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS
+      >
+      struct BOOST_FUNCTION_VOID_REF_MEMBER_INVOKER
+      {
+        static BOOST_FUNCTION_VOID_RETURN_TYPE
+        invoke(function_ref_target target BOOST_FUNCTION_COMMA
+               BOOST_FUNCTION_PARMS)
+
+        {
+          const MemberPtr* f = static_cast<const MemberPtr*>(target.obj_ptr);
+          BOOST_FUNCTION_RETURN(boost::mem_fn(*f)(BOOST_FUNCTION_ARGS));
+        }
+      };
+#endif // BOOST_FUNCTION_NUM_ARGS > 0
+
+      /* Handle invocation of delegates, with a single indirect call. */
+      template<
+        typename Delegate,
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS
+      >
+      struct BOOST_FUNCTION_DELEGATE_INVOKER
+      {
+        static R invoke(function_buffer& function_obj_ptr BOOST_FUNCTION_COMMA
+                        BOOST_FUNCTION_PARMS)
+
+        {
+          const Delegate* f = reinterpret_cast<const Delegate*>(
+                                &function_obj_ptr.members.bound_memfunc_ptr);
+          return (f->object()->*f->member())(BOOST_FUNCTION_ARGS);
+        }
+      };
+
+      template<
+        typename Delegate,
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS
+      >
+      struct BOOST_FUNCTION_VOID_DELEGATE_INVOKER
+      {
+        static BOOST_FUNCTION_VOID_RETURN_TYPE
+        invoke(function_buffer& function_obj_ptr BOOST_FUNCTION_COMMA
+               BOOST_FUNCTION_PARMS)
+
+        {
+          const Delegate* f = reinterpret_cast<const Delegate*>(
+                                &function_obj_ptr.members.bound_memfunc_ptr);
+          BOOST_FUNCTION_RETURN((f->object()->*f->member())(BOOST_FUNCTION_ARGS));
+        }
+      };
+
 #if BOOST_FUNCTION_NUM_ARGS > 0
       /* Handle invocation of member pointers. */
       template<
@@ -255,19 +418,30 @@ namespace boost {
 
       template<
         typename FunctionObj,
+        typename Storage,
         typename R BOOST_FUNCTION_COMMA
         BOOST_FUNCTION_TEMPLATE_PARMS
        >
       struct BOOST_FUNCTION_GET_FUNCTION_OBJ_INVOKER
       {
+        // The placement of the function object is part of the invoker
+        // type, so that translation units that disagree on it (e.g.,
+        // because they are compiled with different language standards)
+        // never share an instantiation.
+        BOOST_STATIC_CONSTANT
+          (bool,
+           small_object = (function_allows_small_object_optimization<FunctionObj, Storage>::value));
+
         typedef typename conditional<(is_void<R>::value),
                             BOOST_FUNCTION_VOID_FUNCTION_OBJ_INVOKER<
                             FunctionObj,
+                            small_object,
                             R BOOST_FUNCTION_COMMA
                             BOOST_FUNCTION_TEMPLATE_ARGS
                           >,
                           BOOST_FUNCTION_FUNCTION_OBJ_INVOKER<
                             FunctionObj,
+                            small_object,
                             R BOOST_FUNCTION_COMMA
                             BOOST_FUNCTION_TEMPLATE_ARGS
                           >
@@ -295,6 +469,28 @@ namespace boost {
                        >::type type;
       };
 
+      /* Retrieve the appropriate invoker for a delegate. */
+      template<
+        typename Delegate,
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS
+       >
+      struct BOOST_FUNCTION_GET_DELEGATE_INVOKER
+      {
+        typedef typename conditional<(is_void<R>::value),
+                            BOOST_FUNCTION_VOID_DELEGATE_INVOKER<
+                            Delegate,
+                            R BOOST_FUNCTION_COMMA
+                            BOOST_FUNCTION_TEMPLATE_ARGS
+                          >,
+                          BOOST_FUNCTION_DELEGATE_INVOKER<
+                            Delegate,
+                            R BOOST_FUNCTION_COMMA
+                            BOOST_FUNCTION_TEMPLATE_ARGS
+                          >
+                       >::type type;
+      };
+
 #if BOOST_FUNCTION_NUM_ARGS > 0
       /* Retrieve the appropriate invoker for a member pointer.  */
       template<
@@ -324,7 +520,8 @@ namespace boost {
          object.
 
          Each specialization contains an "apply" nested class template
-         that accepts the function object, return type, function
+         that accepts the function object, inline storage type, whether
+         the function object may be cloned, return type, function
          argument types, and allocator. The resulting "apply" class
          contains two typedefs, "invoker_type" and "manager_type",
          which correspond to the invoker and manager types. */
@@ -335,7 +532,7 @@ namespace boost {
       template<>
       struct BOOST_FUNCTION_GET_INVOKER<function_ptr_tag>
       {
-        template<typename FunctionPtr,
+        template<typename FunctionPtr, typename Storage, bool Copyable,
                  typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
         struct apply
         {
@@ -349,7 +546,7 @@ namespace boost {
           typedef functor_manager<FunctionPtr> manager_type;
         };
 
-        template<typename FunctionPtr, typename Allocator,
+        template<typename FunctionPtr, typename Allocator, typename Storage, bool Copyable,
                  typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
         struct apply_a
         {
@@ -369,7 +566,7 @@ namespace boost {
       template<>
       struct BOOST_FUNCTION_GET_INVOKER<member_ptr_tag>
       {
-        template<typename MemberPtr,
+        template<typename MemberPtr, typename Storage, bool Copyable,
                  typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
         struct apply
         {
@@ -383,7 +580,7 @@ namespace boost {
           typedef functor_manager<MemberPtr> manager_type;
         };
 
-        template<typename MemberPtr, typename Allocator,
+        template<typename MemberPtr, typename Allocator, typename Storage, bool Copyable,
                  typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
         struct apply_a
         {
@@ -403,32 +600,34 @@ namespace boost {
       template<>
       struct BOOST_FUNCTION_GET_INVOKER<function_obj_tag>
       {
-        template<typename FunctionObj,
+        template<typename FunctionObj, typename Storage, bool Copyable,
                  typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
         struct apply
         {
           typedef typename BOOST_FUNCTION_GET_FUNCTION_OBJ_INVOKER<
                              FunctionObj,
+                             Storage,
                              R BOOST_FUNCTION_COMMA
                              BOOST_FUNCTION_TEMPLATE_ARGS
                            >::type
             invoker_type;
 
-          typedef functor_manager<FunctionObj> manager_type;
+          typedef functor_manager<FunctionObj, Storage, Copyable> manager_type;
         };
 
-        template<typename FunctionObj, typename Allocator,
+        template<typename FunctionObj, typename Allocator, typename Storage, bool Copyable,
                  typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
         struct apply_a
         {
           typedef typename BOOST_FUNCTION_GET_FUNCTION_OBJ_INVOKER<
                              FunctionObj,
+                             Storage,
                              R BOOST_FUNCTION_COMMA
                              BOOST_FUNCTION_TEMPLATE_ARGS
                            >::type
             invoker_type;
 
-          typedef functor_manager_a<FunctionObj, Allocator> manager_type;
+          typedef functor_manager_a<FunctionObj, Allocator, Storage, Copyable> manager_type;
         };
       };
 
@@ -436,7 +635,7 @@ namespace boost {
       template<>
       struct BOOST_FUNCTION_GET_INVOKER<function_obj_ref_tag>
       {
-        template<typename RefWrapper,
+        template<typename RefWrapper, typename Storage, bool Copyable,
                  typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
         struct apply
         {
@@ -450,7 +649,7 @@ namespace boost {
           typedef reference_manager<typename RefWrapper::type> manager_type;
         };
 
-        template<typename RefWrapper, typename Allocator,
+        template<typename RefWrapper, typename Allocator, typename Storage, bool Copyable,
                  typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
         struct apply_a
         {
@@ -465,6 +664,39 @@ namespace boost {
         };
       };
 
+      /* Retrieve the invoker for a delegate. */
+      template<>
+      struct BOOST_FUNCTION_GET_INVOKER<delegate_tag>
+      {
+        template<typename Delegate, typename Storage, bool Copyable,
+                 typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
+        struct apply
+        {
+          typedef typename BOOST_FUNCTION_GET_DELEGATE_INVOKER<
+                             Delegate,
+                             R BOOST_FUNCTION_COMMA
+                             BOOST_FUNCTION_TEMPLATE_ARGS
+                           >::type
+            invoker_type;
+
+          typedef delegate_manager<Delegate> manager_type;
+        };
+
+        template<typename Delegate, typename Allocator, typename Storage, bool Copyable,
+                 typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
+        struct apply_a
+        {
+          typedef typename BOOST_FUNCTION_GET_DELEGATE_INVOKER<
+                             Delegate,
+                             R BOOST_FUNCTION_COMMA
+                             BOOST_FUNCTION_TEMPLATE_ARGS
+                           >::type
+            invoker_type;
+
+          typedef delegate_manager<Delegate> manager_type;
+        };
+      };
+
 
       /**
        * vtable for a specific boost::function instance. This
@@ -486,30 +718,57 @@ namespace boost {
                                             BOOST_FUNCTION_COMMA
                                             BOOST_FUNCTION_TEMPLATE_ARGS);
 
-        template<typename F>
-        bool assign_to(F f, function_buffer& functor) const
+        // Stores f in functor. The caller passes where f goes, inline or
+        // on the heap, so that these never decide it differently from the
+        // vtable of the caller.
+        template<typename F, typename Storage, bool Inline>
+        bool assign_to(BOOST_FUNCTION_FWD_REF(F) f, Storage& functor,
+                       integral_constant<bool, Inline> placement) const
         {
-          typedef typename get_function_tag<F>::type tag;
-          return assign_to(f, functor, tag());
+          typedef typename get_function_tag<typename decay<F>::type>::type tag;
+          return assign_to(BOOST_FUNCTION_FORWARD(F, f), functor, tag(), placement);
         }
-        template<typename F,typename Allocator>
-        bool assign_to_a(F f, function_buffer& functor, Allocator a) const
+        template<typename F,typename Allocator, typename Storage, bool Inline>
+        bool assign_to_a(BOOST_FUNCTION_FWD_REF(F) f, Storage& functor, Allocator a,
+                         integral_constant<bool, Inline> placement) const
+        {
+          typedef typename get_function_tag<typename decay<F>::type>::type tag;
+          return assign_to_a(BOOST_FUNCTION_FORWARD(F, f), functor, a, tag(), placement);
+        }
+
+        template<typename Storage>
+        void clear(Storage& functor) const
         {
-          typedef typename get_function_tag<F>::type tag;
-          return assign_to_a(f, functor, a, tag());
+          if (base.destroy)
+            base.destroy(get_function_buffer(functor));
         }
 
-        void clear(function_buffer& functor) const
+        // The vtable that empty functions point to. Its invoker throws
+        // bad_function_call, so that calls do not test for emptiness, and
+        // its tag bits make copying, moving and clearing it no-ops and mark
+        // it as empty.
+        static vtable_base* empty_vtable()
         {
-          if (base.manager)
-            base.manager(functor, functor, destroy_functor_tag);
+          static const BOOST_FUNCTION_VTABLE stored_vtable =
+            { { &empty_manager, 0, 0, 0, &functor_identity<void>::id,
+                &empty_hash, &empty_equal },
+              &empty_invoke };
+          return reinterpret_cast<vtable_base*>(
+                   reinterpret_cast<std::size_t>(&stored_vtable.base) | 0x07);
+        }
+
+      private:
+        static result_type empty_invoke(function_buffer& BOOST_FUNCTION_COMMA
+                                        BOOST_FUNCTION_TEMPLATE_ARGS)
+        {
+          boost::throw_exception(bad_function_call());
         }
 
       private:
         // Function pointers
-        template<typename FunctionPtr>
+        template<typename FunctionPtr, typename Storage, typename Placement>
         bool
-        assign_to(FunctionPtr f, function_buffer& functor, function_ptr_tag) const
+        assign_to(FunctionPtr f, Storage& functor, function_ptr_tag, Placement) const
         {
           this->clear(functor);
           if (f) {
@@ -521,36 +780,61 @@ namespace boost {
             return false;
           }
         }
-        template<typename FunctionPtr,typename Allocator>
+        template<typename FunctionPtr,typename Allocator, typename Storage,
+                 typename Placement>
         bool
-        assign_to_a(FunctionPtr f, function_buffer& functor, Allocator, function_ptr_tag) const
+        assign_to_a(FunctionPtr f, Storage& functor, Allocator, function_ptr_tag,
+                    Placement placement) const
+        {
+          return assign_to(f,functor,function_ptr_tag(),placement);
+        }
+
+        // Delegates, which are empty when their member pointer is null
+        template<typename Delegate, typename Storage, typename Placement>
+        bool assign_to(const Delegate& f, Storage& functor, delegate_tag, Placement) const
+        {
+          if (f.member()) {
+            new (reinterpret_cast<void*>(&get_function_buffer(functor).members.bound_memfunc_ptr))
+              Delegate(f);
+            return true;
+          } else {
+            return false;
+          }
+        }
+        template<typename Delegate,typename Allocator, typename Storage,
+                 typename Placement>
+        bool assign_to_a(const Delegate& f, Storage& functor, Allocator, delegate_tag,
+                         Placement placement) const
         {
-          return assign_to(f,functor,function_ptr_tag());
+          return assign_to(f,functor,delegate_tag(),placement);
         }
 
         // Member pointers
 #if BOOST_FUNCTION_NUM_ARGS > 0
-        template<typename MemberPtr>
-        bool assign_to(MemberPtr f, function_buffer& functor, member_ptr_tag) const
+        template<typename MemberPtr, typename Storage, typename Placement>
+        bool assign_to(MemberPtr f, Storage& functor, member_ptr_tag,
+                       Placement placement) const
         {
           // DPG TBD: Add explicit support for member function
           // objects, so we invoke through mem_fn() but we retain the
           // right target_type() values.
           if (f) {
-            this->assign_to(boost::mem_fn(f), functor);
+            this->assign_to(boost::mem_fn(f), functor, placement);
             return true;
           } else {
             return false;
           }
         }
-        template<typename MemberPtr,typename Allocator>
-        bool assign_to_a(MemberPtr f, function_buffer& functor, Allocator a, member_ptr_tag) const
+        template<typename MemberPtr,typename Allocator, typename Storage,
+                 typename Placement>
+        bool assign_to_a(MemberPtr f, Storage& functor, Allocator a, member_ptr_tag,
+                         Placement placement) const
         {
           // DPG TBD: Add explicit support for member function
           // objects, so we invoke through mem_fn() but we retain the
           // right target_type() values.
           if (f) {
-            this->assign_to_a(boost::mem_fn(f), functor, a);
+            this->assign_to_a(boost::mem_fn(f), functor, a, placement);
             return true;
           } else {
             return false;
@@ -560,30 +844,36 @@ namespace boost {
 
         // Function objects
         // Assign to a function object using the small object optimization
-        template<typename FunctionObj>
+        template<typename F, typename Storage>
         void
-        assign_functor(FunctionObj f, function_buffer& functor, true_type) const
+        assign_functor(BOOST_FUNCTION_FWD_REF(F) f, Storage& functor, true_type) const
         {
-          new (reinterpret_cast<void*>(functor.data)) FunctionObj(f);
+          typedef typename decay<F>::type FunctionObj;
+          new (reinterpret_cast<void*>(functor.data)) FunctionObj(BOOST_FUNCTION_FORWARD(F, f));
         }
-        template<typename FunctionObj,typename Allocator>
+        template<typename F,typename Allocator, typename Storage>
         void
-        assign_functor_a(FunctionObj f, function_buffer& functor, Allocator, true_type) const
+        assign_functor_a(BOOST_FUNCTION_FWD_REF(F) f, Storage& functor, Allocator, true_type) const
         {
-          assign_functor(f,functor,true_type());
+          assign_functor(BOOST_FUNCTION_FORWARD(F, f),functor,true_type());
         }
 
         // Assign to a function object allocated on the heap.
-        template<typename FunctionObj>
+        template<typename F, typename Storage>
         void
-        assign_functor(FunctionObj f, function_buffer& functor, false_type) const
+        assign_functor(BOOST_FUNCTION_FWD_REF(F) f, Storage& functor, false_type) const
         {
-          functor.members.obj_ptr = new FunctionObj(f);
+          typedef typename decay<F>::type FunctionObj;
+          functor.members.obj_ptr =
+            new_functor(BOOST_FUNCTION_FORWARD(F, f),
+                        integral_constant<bool, is_over_aligned<FunctionObj>::value>());
         }
-        template<typename FunctionObj,typename Allocator>
+
+        template<typename F,typename Allocator, typename Storage>
         void
-        assign_functor_a(FunctionObj f, function_buffer& functor, Allocator a, false_type) const
+        assign_functor_a(BOOST_FUNCTION_FWD_REF(F) f, Storage& functor, Allocator a, false_type) const
         {
+          typedef typename decay<F>::type FunctionObj;
           typedef functor_wrapper<FunctionObj,Allocator> functor_wrapper_type;
 #if defined(BOOST_NO_CXX11_ALLOCATOR)
           typedef typename Allocator::template rebind<functor_wrapper_type>::other
@@ -598,31 +888,31 @@ namespace boost {
 #if defined(BOOST_NO_CXX11_ALLOCATOR)
           wrapper_allocator.construct(copy, functor_wrapper_type(f,a));
 #else
-          std::allocator_traits<wrapper_allocator_type>::construct(wrapper_allocator, copy, functor_wrapper_type(f,a));
+          std::allocator_traits<wrapper_allocator_type>::construct(wrapper_allocator, copy, BOOST_FUNCTION_FORWARD(F, f), a);
 #endif
           functor_wrapper_type* new_f = static_cast<functor_wrapper_type*>(copy);
           functor.members.obj_ptr = new_f;
         }
 
-        template<typename FunctionObj>
+        template<typename F, typename Storage, typename Placement>
         bool
-        assign_to(FunctionObj f, function_buffer& functor, function_obj_tag) const
+        assign_to(BOOST_FUNCTION_FWD_REF(F) f, Storage& functor, function_obj_tag,
+                  Placement placement) const
         {
           if (!boost::detail::function::has_empty_target(boost::addressof(f))) {
-            assign_functor(f, functor,
-                           integral_constant<bool, (function_allows_small_object_optimization<FunctionObj>::value)>());
+            assign_functor(BOOST_FUNCTION_FORWARD(F, f), functor, placement);
             return true;
           } else {
             return false;
           }
         }
-        template<typename FunctionObj,typename Allocator>
+        template<typename F,typename Allocator, typename Storage, typename Placement>
         bool
-        assign_to_a(FunctionObj f, function_buffer& functor, Allocator a, function_obj_tag) const
+        assign_to_a(BOOST_FUNCTION_FWD_REF(F) f, Storage& functor, Allocator a, function_obj_tag,
+                    Placement placement) const
         {
           if (!boost::detail::function::has_empty_target(boost::addressof(f))) {
-            assign_functor_a(f, functor, a,
-                           integral_constant<bool, (function_allows_small_object_optimization<FunctionObj>::value)>());
+            assign_functor_a(BOOST_FUNCTION_FORWARD(F, f), functor, a, placement);
             return true;
           } else {
             return false;
@@ -630,145 +920,749 @@ namespace boost {
         }
 
         // Reference to a function object
-        template<typename FunctionObj>
+        template<typename FunctionObj, typename Storage, typename Placement>
         bool
         assign_to(const reference_wrapper<FunctionObj>& f,
-                  function_buffer& functor, function_obj_ref_tag) const
+                  Storage& functor, function_obj_ref_tag, Placement) const
         {
           functor.members.obj_ref.obj_ptr = (void *)(f.get_pointer());
           functor.members.obj_ref.is_const_qualified = is_const<FunctionObj>::value;
           functor.members.obj_ref.is_volatile_qualified = is_volatile<FunctionObj>::value;
           return true;
         }
-        template<typename FunctionObj,typename Allocator>
+        template<typename FunctionObj,typename Allocator, typename Storage,
+                 typename Placement>
         bool
         assign_to_a(const reference_wrapper<FunctionObj>& f,
-                  function_buffer& functor, Allocator, function_obj_ref_tag) const
+                  Storage& functor, Allocator, function_obj_ref_tag,
+                  Placement placement) const
         {
-          return assign_to(f,functor,function_obj_ref_tag());
+          return assign_to(f,functor,function_obj_ref_tag(),placement);
         }
 
       public:
         vtable_base base;
         invoker_type invoker;
       };
-    } // end namespace function
-  } // end namespace detail
 
-  template<
-    typename R BOOST_FUNCTION_COMMA
-    BOOST_FUNCTION_TEMPLATE_PARMS
-  >
-  class BOOST_FUNCTION_FUNCTION : public function_base
-  {
-  public:
+      /**
+       * The body shared by BOOST_FUNCTION_FUNCTION and
+       * BOOST_FUNCTION_UNIQUE_FUNCTION: calling, clearing and testing the
+       * target, and assigning, moving and swapping targets. Copyable tells
+       * whether the managers of the targets need to clone them. The
+       * wrappers add the constructors and assignment operators, and
+       * BOOST_FUNCTION_FUNCTION the copying ones.
+       */
+      template<
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS,
+        typename Storage,
+        bool Copyable
+      >
+      class BOOST_FUNCTION_FUNCTION_IMPL
+        : public boost::detail::function::function_base_type<Storage>::type
+      {
+      protected:
+        typedef typename boost::detail::function::function_base_type<Storage>::type
+          function_base_type;
+
+      public:
 #ifndef BOOST_NO_VOID_RETURNS
-    typedef R         result_type;
+        typedef R         result_type;
 #else
-    typedef  typename boost::detail::function::function_return_type<R>::type
-      result_type;
+        typedef  typename function_return_type<R>::type
+          result_type;
 #endif // BOOST_NO_VOID_RETURNS
 
-  private:
-    typedef boost::detail::function::BOOST_FUNCTION_VTABLE<
-              R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>
-      vtable_type;
-
-    vtable_type* get_vtable() const {
-      return reinterpret_cast<vtable_type*>(
-               reinterpret_cast<std::size_t>(vtable) & ~static_cast<std::size_t>(0x01));
-    }
+      protected:
+        typedef BOOST_FUNCTION_VTABLE<R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>
+          vtable_type;
 
-    struct clear_type {};
+        vtable_type* get_vtable() const {
+          return reinterpret_cast<vtable_type*>(
+                   reinterpret_cast<std::size_t>(this->vtable) & ~static_cast<std::size_t>(0x0f));
+        }
 
-  public:
-    BOOST_STATIC_CONSTANT(int, args = BOOST_FUNCTION_NUM_ARGS);
+      public:
+        BOOST_STATIC_CONSTANT(int, args = BOOST_FUNCTION_NUM_ARGS);
 
-    // add signature for boost::lambda
-    template<typename Args>
-    struct sig
-    {
-      typedef result_type type;
-    };
+        // add signature for boost::lambda
+        template<typename Args>
+        struct sig
+        {
+          typedef result_type type;
+        };
 
 #if BOOST_FUNCTION_NUM_ARGS == 1
-    typedef T0 argument_type;
+        typedef T0 argument_type;
 #elif BOOST_FUNCTION_NUM_ARGS == 2
-    typedef T0 first_argument_type;
-    typedef T1 second_argument_type;
+        typedef T0 first_argument_type;
+        typedef T1 second_argument_type;
 #endif
 
-    BOOST_STATIC_CONSTANT(int, arity = BOOST_FUNCTION_NUM_ARGS);
-    BOOST_FUNCTION_ARG_TYPES
+        BOOST_STATIC_CONSTANT(int, arity = BOOST_FUNCTION_NUM_ARGS);
+        BOOST_FUNCTION_ARG_TYPES
 
-    typedef BOOST_FUNCTION_FUNCTION self_type;
+        result_type operator()(BOOST_FUNCTION_PARMS) const
+        {
+#ifdef BOOST_FUNCTION_CACHE_INVOKER
+          return reinterpret_cast<typename vtable_type::invoker_type>(this->invoker)
+                   (this->get_functor_buffer() BOOST_FUNCTION_COMMA BOOST_FUNCTION_ARGS);
+#else
+          return get_vtable()->invoker
+                   (this->get_functor_buffer() BOOST_FUNCTION_COMMA BOOST_FUNCTION_ARGS);
+#endif
+        }
 
-    BOOST_DEFAULTED_FUNCTION(BOOST_FUNCTION_FUNCTION(), : function_base() {})
+        // Calls the target like operator(), guessing that it is of type F1, F2
+        // or F3. A guess is checked by comparing the vtable pointer with the
+        // vtable of that type, and on a hit the invoker of the type is called
+        // directly, so that the compiler can inline it. Otherwise, including
+        // for targets assigned with an allocator, the call goes through the
+        // vtable.
+        template<typename F1>
+        result_type invoke_as(BOOST_FUNCTION_PARMS) const
+        {
+          if (get_vtable() == vtable_for<F1>())
+            return handler<F1>::type::invoker_type::invoke
+                     (this->get_functor_buffer() BOOST_FUNCTION_COMMA BOOST_FUNCTION_ARGS);
+          return (*this)(BOOST_FUNCTION_ARGS);
+        }
 
-    // MSVC chokes if the following two constructors are collapsed into
-    // one with a default parameter.
-    template<typename Functor>
-    BOOST_FUNCTION_FUNCTION(Functor BOOST_FUNCTION_TARGET_FIX(const &) f
-#ifndef BOOST_NO_SFINAE
-                            ,typename boost::enable_if_<
-                             !(is_integral<Functor>::value),
-                                        int>::type = 0
-#endif // BOOST_NO_SFINAE
-                            ) :
-      function_base()
-    {
-      this->assign_to(f);
-    }
-    template<typename Functor,typename Allocator>
-    BOOST_FUNCTION_FUNCTION(Functor BOOST_FUNCTION_TARGET_FIX(const &) f, Allocator a
-#ifndef BOOST_NO_SFINAE
-                            ,typename boost::enable_if_<
-                              !(is_integral<Functor>::value),
-                                        int>::type = 0
-#endif // BOOST_NO_SFINAE
-                            ) :
-      function_base()
-    {
-      this->assign_to_a(f,a);
-    }
+        template<typename F1, typename F2>
+        result_type invoke_as(BOOST_FUNCTION_PARMS) const
+        {
+          if (get_vtable() == vtable_for<F1>())
+            return handler<F1>::type::invoker_type::invoke
+                     (this->get_functor_buffer() BOOST_FUNCTION_COMMA BOOST_FUNCTION_ARGS);
+          return this->template invoke_as<F2>(BOOST_FUNCTION_ARGS);
+        }
 
-#ifndef BOOST_NO_SFINAE
-    BOOST_FUNCTION_FUNCTION(clear_type*) : function_base() { }
+        template<typename F1, typename F2, typename F3>
+        result_type invoke_as(BOOST_FUNCTION_PARMS) const
+        {
+          if (get_vtable() == vtable_for<F1>())
+            return handler<F1>::type::invoker_type::invoke
+                     (this->get_functor_buffer() BOOST_FUNCTION_COMMA BOOST_FUNCTION_ARGS);
+          return this->template invoke_as<F2, F3>(BOOST_FUNCTION_ARGS);
+        }
+
+        // Clear out a target, if there is one
+        void clear()
+        {
+          if (!this->has_trivial_copy_and_destroy())
+            get_vtable()->clear(this->functor);
+          this->set_empty();
+        }
+
+#if (defined __SUNPRO_CC) && (__SUNPRO_CC <= 0x530) && !(defined BOOST_NO_COMPILER_CONFIG)
+        // Sun C++ 5.3 can't handle the safe_bool idiom, so don't use it
+        operator bool () const { return !this->empty(); }
 #else
-    BOOST_FUNCTION_FUNCTION(int zero) : function_base()
-    {
-      BOOST_ASSERT(zero == 0);
-    }
-#endif
+      private:
+        struct dummy {
+          void nonnull() {}
+        };
 
-    BOOST_FUNCTION_FUNCTION(const BOOST_FUNCTION_FUNCTION& f) : function_base()
-    {
-      this->assign_to_own(f);
-    }
+        typedef void (dummy::*safe_bool)();
 
-#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
-    BOOST_FUNCTION_FUNCTION(BOOST_FUNCTION_FUNCTION&& f) : function_base()
-    {
-      this->move_assign(f);
-    }
+      public:
+        operator safe_bool () const
+          { return (this->empty())? 0 : &dummy::nonnull; }
+
+        bool operator!() const
+          { return this->empty(); }
 #endif
 
-    ~BOOST_FUNCTION_FUNCTION() { clear(); }
+      protected:
+        BOOST_FUNCTION_FUNCTION_IMPL() : function_base_type() { this->set_empty(); }
 
-    result_type operator()(BOOST_FUNCTION_PARMS) const
-    {
-      if (this->empty())
-        boost::throw_exception(bad_function_call());
+        ~BOOST_FUNCTION_FUNCTION_IMPL() { clear(); }
 
-      return get_vtable()->invoker
-               (this->functor BOOST_FUNCTION_COMMA BOOST_FUNCTION_ARGS);
-    }
+        void set_empty()
+        {
+          this->vtable = vtable_type::empty_vtable();
+          this->cache_invoker();
+        }
+
+        // Copies the invoker of the vtable next to the buffer, when
+        // BOOST_FUNCTION_CACHE_INVOKER is defined
+        void cache_invoker()
+        {
+#ifdef BOOST_FUNCTION_CACHE_INVOKER
+          this->invoker = reinterpret_cast<generic_invoker>(get_vtable()->invoker);
+#endif
+        }
+
+        // Points at the vtable v of targets of type Functor, stored inline
+        // when Inline is true
+        template<typename Functor, bool Inline>
+        void set_vtable(const vtable_base* v)
+        {
+          std::size_t value = reinterpret_cast<std::size_t>(v) |
+            vtable_tag_bits<Functor, Storage, Inline>::value;
+          this->vtable = reinterpret_cast<vtable_base*>(value);
+          this->cache_invoker();
+        }
+
+        // Copies the target of f into *this, which must be empty
+        void assign_to_own(const BOOST_FUNCTION_FUNCTION_IMPL& f)
+        {
+          if (!f.empty()) {
+            this->vtable = f.vtable;
+            this->copy_invoker(f);
+            if (this->has_trivial_copy_and_destroy()) {
+              // Don't operate on storage directly since union type doesn't relax
+              // strict aliasing rules, despite of having member char type.
+#             if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
+#               pragma GCC diagnostic push
+                // This warning is technically correct, but we don't want to pay the price for initializing
+                // just to silence a warning: https://github.com/boostorg/function/issues/27
+#               pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#             endif
+              std::memcpy(this->functor.data, f.functor.data, sizeof(this->functor));
+#             if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
+#               pragma GCC diagnostic pop
+#             endif
+            } else
+              get_vtable()->base.clone(f.get_functor_buffer(), this->get_functor_buffer());
+          }
+        }
+
+        // The invoker and manager of targets of type Functor assigned
+        // without an allocator
+        template<typename Functor>
+        struct handler
+        {
+          typedef typename get_function_tag<Functor>::type tag;
+          typedef BOOST_FUNCTION_GET_INVOKER<tag> get_invoker;
+          typedef typename get_invoker::
+                             template apply<Functor, Storage, Copyable, R BOOST_FUNCTION_COMMA
+                            BOOST_FUNCTION_TEMPLATE_ARGS>
+            type;
+        };
+
+        // The vtable of targets of type Functor assigned without an allocator
+        template<typename Functor>
+        static const vtable_type* vtable_for()
+        {
+          return placed_vtable_for<Functor,
+                                   is_stored_inline<Functor, Storage>::value>();
+        }
+
+        // The vtable of vtable_for, for targets stored inline when Inline
+        // is true. Whether a function object is stored inline depends on
+        // the language standard, so the placement is part of the name of
+        // this function and of its static vtable: translation units
+        // compiled with different standards must not share them.
+        template<typename Functor, bool Inline>
+        static const vtable_type* placed_vtable_for()
+        {
+          typedef typename handler<Functor>::type handler_type;
+          typedef typename handler_type::invoker_type invoker_type;
+          typedef typename handler_type::manager_type manager_type;
+          typedef vtable_entries<manager_type, Functor, Storage> entries;
+
+          // Note: it is extremely important that this initialization use
+          // static initialization. Otherwise, we will have a race
+          // condition here in multi-threaded code. See
+          // http://thread.gmane.org/gmane.comp.lib.boost.devel/164902/.
+          static const vtable_type stored_vtable =
+            { { &manager_type::manage,
+                entries::trivial_clone ? 0 : &entries::clone,
+                entries::trivial_move ? 0 : &entries::move,
+                entries::trivial_destroy ? 0 : &entries::destroy,
+                &entries::identity::id,
+                entries::hashable ? &entries::hash : 0,
+                entries::hashable ? &entries::equal : 0 },
+              &invoker_type::invoke };
+
+          return &stored_vtable;
+        }
+
+        template<typename F>
+        void assign_to(BOOST_FUNCTION_FWD_REF(F) f)
+        {
+          typedef typename decay<F>::type Functor;
+          typedef integral_constant<bool, (is_stored_inline<Functor, Storage>::value)>
+            placement;
+          const vtable_type* stored_vtable =
+            placed_vtable_for<Functor, placement::value>();
+
+          if (stored_vtable->assign_to(BOOST_FUNCTION_FORWARD(F, f), this->functor,
+                                       placement()))
+            this->template set_vtable<Functor, placement::value>(&stored_vtable->base);
+          else
+            this->set_empty();
+        }
+
+        // The vtable of targets of type Functor assigned with an allocator of
+        // type Allocator, stored inline when Inline is true. As with
+        // placed_vtable_for, the placement is part of its name.
+        template<typename Functor, typename Allocator, bool Inline>
+        static const vtable_type* placed_vtable_for_a()
+        {
+          typedef typename get_function_tag<Functor>::type tag;
+          typedef BOOST_FUNCTION_GET_INVOKER<tag> get_invoker;
+          typedef boost::detail::function::function_allocator<Allocator> function_allocator;
+          typedef typename get_invoker::
+                             template apply_a<Functor, typename function_allocator::type, Storage,
+                                              Copyable, R BOOST_FUNCTION_COMMA
+                             BOOST_FUNCTION_TEMPLATE_ARGS>
+            handler_type;
+
+          typedef typename handler_type::invoker_type invoker_type;
+          typedef typename handler_type::manager_type manager_type;
+          typedef vtable_entries<manager_type, Functor, Storage> entries;
+
+          // Note: as in placed_vtable_for, this initialization must be
+          // static initialization.
+          static const vtable_type stored_vtable =
+            { { &manager_type::manage,
+                entries::trivial_clone ? 0 : &entries::clone,
+                entries::trivial_move ? 0 : &entries::move,
+                entries::trivial_destroy ? 0 : &entries::destroy,
+                &functor_identity<void>::id,
+                entries::hashable ? &entries::hash : 0,
+                entries::hashable ? &entries::equal : 0 },
+              &invoker_type::invoke };
+
+          return &stored_vtable;
+        }
+
+        template<typename F,typename Allocator>
+        void assign_to_a(BOOST_FUNCTION_FWD_REF(F) f,Allocator a)
+        {
+          typedef typename decay<F>::type Functor;
+          typedef boost::detail::function::function_allocator<Allocator> function_allocator;
+          typedef integral_constant<bool, (is_stored_inline<Functor, Storage>::value)>
+            placement;
+          const vtable_type* stored_vtable =
+            placed_vtable_for_a<Functor, Allocator, placement::value>();
+
+          if (stored_vtable->assign_to_a(BOOST_FUNCTION_FORWARD(F, f), this->functor,
+                                         function_allocator::get(a), placement()))
+            this->template set_vtable<Functor, placement::value>(&stored_vtable->base);
+          else
+            this->set_empty();
+        }
+
+        // Moves the target of f into *this, which must be empty. A target on
+        // the heap is passed on by its pointer, leaving f empty. Function
+        // objects are only stored inline when they are
+        // nothrow-move-constructible, so with rvalue references this never
+        // throws. Without them, the target is copied, and *this is only
+        // given the vtable of f once the copy has succeeded. Trivially
+        // relocatable targets are moved with a memcpy.
+        void move_assign(BOOST_FUNCTION_FUNCTION_IMPL& f) BOOST_NOEXCEPT
+        {
+          if (&f == this || f.empty())
+            return;
+
+          if (f.has_trivial_relocation()) {
+            // Don't operate on storage directly since union type doesn't relax
+            // strict aliasing rules, despite of having member char type.
+#           if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
+#             pragma GCC diagnostic push
+              // This warning is technically correct, but we don't want to pay the price for initializing
+              // just to silence a warning: https://github.com/boostorg/function/issues/27
+#             pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#           endif
+            std::memcpy(this->functor.data, f.functor.data, sizeof(this->functor));
+#           if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
+#             pragma GCC diagnostic pop
+#           endif
+          } else
+            f.get_vtable()->base.move(f.get_functor_buffer(), this->get_functor_buffer());
+          this->vtable = f.vtable;
+          this->copy_invoker(f);
+          f.set_empty();
+        }
+
+        void swap_targets(BOOST_FUNCTION_FUNCTION_IMPL& other) BOOST_NOEXCEPT
+        {
+          if (&other == this)
+            return;
+
+          if (this->has_trivial_relocation() && other.has_trivial_relocation()) {
+            // Neither target needs its manager to be moved, so exchange
+            // the buffers and vtables directly.
+            Storage tmp;
+#           if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
+#             pragma GCC diagnostic push
+#             pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#           endif
+            std::memcpy(tmp.data, this->functor.data, sizeof(this->functor));
+            std::memcpy(this->functor.data, other.functor.data, sizeof(this->functor));
+            std::memcpy(other.functor.data, tmp.data, sizeof(this->functor));
+#           if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
+#             pragma GCC diagnostic pop
+#           endif
+            vtable_base* v = this->vtable;
+            this->vtable = other.vtable;
+            other.vtable = v;
+            this->swap_invoker(other);
+            return;
+          }
+
+          BOOST_FUNCTION_FUNCTION_IMPL tmp;
+          tmp.move_assign(*this);
+          this->move_assign(other);
+          other.move_assign(tmp);
+        }
+      };
+
+      /**
+       * The copyable function class of the signature, storing its target
+       * in Storage. BOOST_FUNCTION_FUNCTION uses a function_buffer, and
+       * boost::basic_function and boost::inplace_function larger ones.
+       */
+      template<
+        typename R BOOST_FUNCTION_COMMA
+        BOOST_FUNCTION_TEMPLATE_PARMS,
+        typename Storage
+      >
+      class BOOST_FUNCTION_BASIC_FUNCTION
+        : public boost::detail::function::BOOST_FUNCTION_FUNCTION_IMPL<
+                   R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS, Storage, true>
+      {
+        typedef boost::detail::function::BOOST_FUNCTION_FUNCTION_IMPL<
+                  R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS, Storage, true>
+          impl_type;
+
+        struct clear_type {};
+
+      public:
+        typedef BOOST_FUNCTION_BASIC_FUNCTION self_type;
+
+        BOOST_FUNCTION_BASIC_FUNCTION() : impl_type() {}
+
+        // MSVC chokes if the following two constructors are collapsed into
+        // one with a default parameter.
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+        template<typename Functor>
+        BOOST_FUNCTION_BASIC_FUNCTION(Functor&& f
+                                ,typename boost::enable_if_<
+                                 (boost::detail::function::is_assignable_functor<
+                                    Functor, BOOST_FUNCTION_BASIC_FUNCTION>::value),
+                                            int>::type = 0
+                                ) :
+          impl_type()
+        {
+          this->assign_to(static_cast<Functor&&>(f));
+        }
+        template<typename Functor,typename Allocator>
+        BOOST_FUNCTION_BASIC_FUNCTION(Functor&& f, Allocator a
+                                ,typename boost::enable_if_<
+                                 (boost::detail::function::is_assignable_functor<
+                                    Functor, BOOST_FUNCTION_BASIC_FUNCTION>::value),
+                                            int>::type = 0
+                                ) :
+          impl_type()
+        {
+          this->assign_to_a(static_cast<Functor&&>(f),a);
+        }
+#else
+        template<typename Functor>
+        BOOST_FUNCTION_BASIC_FUNCTION(Functor BOOST_FUNCTION_TARGET_FIX(const &) f
+#ifndef BOOST_NO_SFINAE
+                                ,typename boost::enable_if_<
+                                 !(is_integral<Functor>::value),
+                                            int>::type = 0
+#endif // BOOST_NO_SFINAE
+                                ) :
+          impl_type()
+        {
+          this->assign_to(f);
+        }
+        template<typename Functor,typename Allocator>
+        BOOST_FUNCTION_BASIC_FUNCTION(Functor BOOST_FUNCTION_TARGET_FIX(const &) f, Allocator a
+#ifndef BOOST_NO_SFINAE
+                                ,typename boost::enable_if_<
+                                  !(is_integral<Functor>::value),
+                                            int>::type = 0
+#endif // BOOST_NO_SFINAE
+                                ) :
+          impl_type()
+        {
+          this->assign_to_a(f,a);
+        }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+#ifndef BOOST_NO_SFINAE
+        BOOST_FUNCTION_BASIC_FUNCTION(clear_type*) : impl_type() {}
+#else
+        BOOST_FUNCTION_BASIC_FUNCTION(int zero) : impl_type()
+        {
+          BOOST_ASSERT(zero == 0);
+        }
+#endif
+
+        BOOST_FUNCTION_BASIC_FUNCTION(const BOOST_FUNCTION_BASIC_FUNCTION& f) : impl_type()
+        {
+          this->assign_to_own(f);
+        }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+        BOOST_FUNCTION_BASIC_FUNCTION(BOOST_FUNCTION_BASIC_FUNCTION&& f) BOOST_NOEXCEPT : impl_type()
+        {
+          this->move_assign(f);
+        }
+#endif
+
+        // The distinction between when to use BOOST_FUNCTION_BASIC_FUNCTION and
+        // when to use self_type is obnoxious. MSVC cannot handle self_type as
+        // the return type of these assignment operators, but Borland C++ cannot
+        // handle BOOST_FUNCTION_BASIC_FUNCTION as the type of the temporary to
+        // construct.
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+        template<typename Functor>
+        typename boost::enable_if_<
+                      (boost::detail::function::is_assignable_functor<
+                         Functor, BOOST_FUNCTION_BASIC_FUNCTION>::value),
+                   BOOST_FUNCTION_BASIC_FUNCTION&>::type
+        operator=(Functor&& f)
+        {
+          this->clear();
+          BOOST_TRY  {
+            this->assign_to(static_cast<Functor&&>(f));
+          } BOOST_CATCH (...) {
+            this->set_empty();
+            BOOST_RETHROW;
+          }
+          BOOST_CATCH_END
+          return *this;
+        }
+        template<typename Functor,typename Allocator>
+        void assign(Functor&& f, Allocator a)
+        {
+          this->clear();
+          BOOST_TRY{
+            this->assign_to_a(static_cast<Functor&&>(f),a);
+          } BOOST_CATCH (...) {
+            this->set_empty();
+            BOOST_RETHROW;
+          }
+          BOOST_CATCH_END
+        }
+#else
+        template<typename Functor>
+#ifndef BOOST_NO_SFINAE
+        typename boost::enable_if_<
+                      !(is_integral<Functor>::value),
+                   BOOST_FUNCTION_BASIC_FUNCTION&>::type
+#else
+        BOOST_FUNCTION_BASIC_FUNCTION&
+#endif
+        operator=(Functor BOOST_FUNCTION_TARGET_FIX(const &) f)
+        {
+          this->clear();
+          BOOST_TRY  {
+            this->assign_to(f);
+          } BOOST_CATCH (...) {
+            this->set_empty();
+            BOOST_RETHROW;
+          }
+          BOOST_CATCH_END
+          return *this;
+        }
+        template<typename Functor,typename Allocator>
+        void assign(Functor BOOST_FUNCTION_TARGET_FIX(const &) f, Allocator a)
+        {
+          this->clear();
+          BOOST_TRY{
+            this->assign_to_a(f,a);
+          } BOOST_CATCH (...) {
+            this->set_empty();
+            BOOST_RETHROW;
+          }
+          BOOST_CATCH_END
+        }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+#ifndef BOOST_NO_SFINAE
+        BOOST_FUNCTION_BASIC_FUNCTION& operator=(clear_type*)
+        {
+          this->clear();
+          return *this;
+        }
+#else
+        BOOST_FUNCTION_BASIC_FUNCTION& operator=(int zero)
+        {
+          BOOST_ASSERT(zero == 0);
+          this->clear();
+          return *this;
+        }
+#endif
+
+        // Assignment from another BOOST_FUNCTION_BASIC_FUNCTION
+        BOOST_FUNCTION_BASIC_FUNCTION& operator=(const BOOST_FUNCTION_BASIC_FUNCTION& f)
+        {
+          if (&f == this)
+            return *this;
+
+          this->clear();
+          BOOST_TRY {
+            this->assign_to_own(f);
+          } BOOST_CATCH (...) {
+            this->set_empty();
+            BOOST_RETHROW;
+          }
+          BOOST_CATCH_END
+          return *this;
+        }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+        // Move assignment from another BOOST_FUNCTION_BASIC_FUNCTION
+        BOOST_FUNCTION_BASIC_FUNCTION& operator=(BOOST_FUNCTION_BASIC_FUNCTION&& f) BOOST_NOEXCEPT
+        {
+          if (&f != this) {
+            this->clear();
+            this->move_assign(f);
+          }
+          return *this;
+        }
+#endif
+
+        void swap(BOOST_FUNCTION_BASIC_FUNCTION& other) BOOST_NOEXCEPT
+        {
+          this->swap_targets(other);
+        }
+      };
+
+      template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS,
+               typename Storage>
+      inline void swap(BOOST_FUNCTION_BASIC_FUNCTION<
+                         R BOOST_FUNCTION_COMMA
+                         BOOST_FUNCTION_TEMPLATE_ARGS,
+                         Storage
+                       >& f1,
+                       BOOST_FUNCTION_BASIC_FUNCTION<
+                         R BOOST_FUNCTION_COMMA
+                         BOOST_FUNCTION_TEMPLATE_ARGS,
+                         Storage
+                       >& f2) BOOST_NOEXCEPT
+      {
+        f1.swap(f2);
+      }
+
+      // Poison comparisons between function objects of the same type.
+      template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS,
+               typename Storage>
+        void operator==(const BOOST_FUNCTION_BASIC_FUNCTION<
+                                R BOOST_FUNCTION_COMMA
+                                BOOST_FUNCTION_TEMPLATE_ARGS, Storage>&,
+                        const BOOST_FUNCTION_BASIC_FUNCTION<
+                                R BOOST_FUNCTION_COMMA
+                                BOOST_FUNCTION_TEMPLATE_ARGS, Storage>&);
+      template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS,
+               typename Storage>
+        void operator!=(const BOOST_FUNCTION_BASIC_FUNCTION<
+                                R BOOST_FUNCTION_COMMA
+                                BOOST_FUNCTION_TEMPLATE_ARGS, Storage>&,
+                        const BOOST_FUNCTION_BASIC_FUNCTION<
+                                R BOOST_FUNCTION_COMMA
+                                BOOST_FUNCTION_TEMPLATE_ARGS, Storage>& );
+
+    } // end namespace function
+  } // end namespace detail
+
+  template<
+    typename R BOOST_FUNCTION_COMMA
+    BOOST_FUNCTION_TEMPLATE_PARMS
+  >
+  class BOOST_FUNCTION_FUNCTION
+    : public boost::detail::function::BOOST_FUNCTION_BASIC_FUNCTION<
+               R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS,
+               boost::detail::function::function_buffer>
+  {
+    typedef boost::detail::function::BOOST_FUNCTION_BASIC_FUNCTION<
+              R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS,
+              boost::detail::function::function_buffer>
+      base_type;
+
+    struct clear_type {};
+
+  public:
+    typedef BOOST_FUNCTION_FUNCTION self_type;
+
+    BOOST_DEFAULTED_FUNCTION(BOOST_FUNCTION_FUNCTION(), : base_type() {})
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    template<typename Functor>
+    BOOST_FUNCTION_FUNCTION(Functor&& f
+                            ,typename boost::enable_if_<
+                             (boost::detail::function::is_assignable_functor<
+                                Functor, self_type, base_type>::value),
+                                        int>::type = 0
+                            ) :
+      base_type(static_cast<Functor&&>(f))
+    {
+    }
+    template<typename Functor,typename Allocator>
+    BOOST_FUNCTION_FUNCTION(Functor&& f, Allocator a
+                            ,typename boost::enable_if_<
+                             (boost::detail::function::is_assignable_functor<
+                                Functor, self_type, base_type>::value),
+                                        int>::type = 0
+                            ) :
+      base_type(static_cast<Functor&&>(f),a)
+    {
+    }
+#else
+    template<typename Functor>
+    BOOST_FUNCTION_FUNCTION(Functor BOOST_FUNCTION_TARGET_FIX(const &) f
+#ifndef BOOST_NO_SFINAE
+                            ,typename boost::enable_if_<
+                             !(is_integral<Functor>::value),
+                                        int>::type = 0
+#endif // BOOST_NO_SFINAE
+                            ) :
+      base_type(f)
+    {
+    }
+    template<typename Functor,typename Allocator>
+    BOOST_FUNCTION_FUNCTION(Functor BOOST_FUNCTION_TARGET_FIX(const &) f, Allocator a
+#ifndef BOOST_NO_SFINAE
+                            ,typename boost::enable_if_<
+                              !(is_integral<Functor>::value),
+                                        int>::type = 0
+#endif // BOOST_NO_SFINAE
+                            ) :
+      base_type(f,a)
+    {
+    }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+#ifndef BOOST_NO_SFINAE
+    BOOST_FUNCTION_FUNCTION(clear_type*) : base_type() {}
+#else
+    BOOST_FUNCTION_FUNCTION(int zero) : base_type()
+    {
+      BOOST_ASSERT(zero == 0);
+    }
+#endif
+
+    BOOST_FUNCTION_FUNCTION(const BOOST_FUNCTION_FUNCTION& f)
+      : base_type(static_cast<const base_type&>(f)) {}
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    BOOST_FUNCTION_FUNCTION(BOOST_FUNCTION_FUNCTION&& f) BOOST_NOEXCEPT
+      : base_type(static_cast<base_type&&>(f)) {}
+#endif
 
-    // The distinction between when to use BOOST_FUNCTION_FUNCTION and
-    // when to use self_type is obnoxious. MSVC cannot handle self_type as
-    // the return type of these assignment operators, but Borland C++ cannot
-    // handle BOOST_FUNCTION_FUNCTION as the type of the temporary to
-    // construct.
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    template<typename Functor>
+    typename boost::enable_if_<
+                  (boost::detail::function::is_assignable_functor<
+                     Functor, self_type, base_type>::value),
+               BOOST_FUNCTION_FUNCTION&>::type
+    operator=(Functor&& f)
+    {
+      base_type::operator=(static_cast<Functor&&>(f));
+      return *this;
+    }
+#else
     template<typename Functor>
 #ifndef BOOST_NO_SFINAE
     typename boost::enable_if_<
@@ -779,28 +1673,10 @@ namespace boost {
 #endif
     operator=(Functor BOOST_FUNCTION_TARGET_FIX(const &) f)
     {
-      this->clear();
-      BOOST_TRY  {
-        this->assign_to(f);
-      } BOOST_CATCH (...) {
-        vtable = 0;
-        BOOST_RETHROW;
-      }
-      BOOST_CATCH_END
+      base_type::operator=(f);
       return *this;
     }
-    template<typename Functor,typename Allocator>
-    void assign(Functor BOOST_FUNCTION_TARGET_FIX(const &) f, Allocator a)
-    {
-      this->clear();
-      BOOST_TRY{
-        this->assign_to_a(f,a);
-      } BOOST_CATCH (...) {
-        vtable = 0;
-        BOOST_RETHROW;
-      }
-      BOOST_CATCH_END
-    }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
 
 #ifndef BOOST_NO_SFINAE
     BOOST_FUNCTION_FUNCTION& operator=(clear_type*)
@@ -817,266 +1693,521 @@ namespace boost {
     }
 #endif
 
-    // Assignment from another BOOST_FUNCTION_FUNCTION
     BOOST_FUNCTION_FUNCTION& operator=(const BOOST_FUNCTION_FUNCTION& f)
     {
-      if (&f == this)
-        return *this;
+      base_type::operator=(static_cast<const base_type&>(f));
+      return *this;
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    BOOST_FUNCTION_FUNCTION& operator=(BOOST_FUNCTION_FUNCTION&& f) BOOST_NOEXCEPT
+    {
+      base_type::operator=(static_cast<base_type&&>(f));
+      return *this;
+    }
+#endif
+
+    void swap(BOOST_FUNCTION_FUNCTION& other) BOOST_NOEXCEPT
+    {
+      base_type::swap(other);
+    }
+  };
+
+  template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
+  inline void swap(BOOST_FUNCTION_FUNCTION<
+                     R BOOST_FUNCTION_COMMA
+                     BOOST_FUNCTION_TEMPLATE_ARGS
+                   >& f1,
+                   BOOST_FUNCTION_FUNCTION<
+                     R BOOST_FUNCTION_COMMA
+                     BOOST_FUNCTION_TEMPLATE_ARGS
+                   >& f2) BOOST_NOEXCEPT
+  {
+    f1.swap(f2);
+  }
+
+// Poison comparisons between boost::function objects of the same type.
+template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
+  void operator==(const BOOST_FUNCTION_FUNCTION<
+                          R BOOST_FUNCTION_COMMA
+                          BOOST_FUNCTION_TEMPLATE_ARGS>&,
+                  const BOOST_FUNCTION_FUNCTION<
+                          R BOOST_FUNCTION_COMMA
+                          BOOST_FUNCTION_TEMPLATE_ARGS>&);
+template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
+  void operator!=(const BOOST_FUNCTION_FUNCTION<
+                          R BOOST_FUNCTION_COMMA
+                          BOOST_FUNCTION_TEMPLATE_ARGS>&,
+                  const BOOST_FUNCTION_FUNCTION<
+                          R BOOST_FUNCTION_COMMA
+                          BOOST_FUNCTION_TEMPLATE_ARGS>& );
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  // A move-only counterpart of BOOST_FUNCTION_FUNCTION. Its targets are
+  // never cloned, so they only need to be move constructible.
+  template<
+    typename R BOOST_FUNCTION_COMMA
+    BOOST_FUNCTION_TEMPLATE_PARMS,
+    typename Storage = boost::detail::function::function_buffer
+  >
+  class BOOST_FUNCTION_UNIQUE_FUNCTION
+    : public boost::detail::function::BOOST_FUNCTION_FUNCTION_IMPL<
+               R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS, Storage, false>
+  {
+    typedef boost::detail::function::BOOST_FUNCTION_FUNCTION_IMPL<
+              R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS, Storage, false>
+      impl_type;
+
+    struct clear_type {};
+
+  public:
+    typedef BOOST_FUNCTION_UNIQUE_FUNCTION self_type;
+
+    BOOST_FUNCTION_UNIQUE_FUNCTION() : impl_type() {}
+
+    template<typename Functor>
+    BOOST_FUNCTION_UNIQUE_FUNCTION(Functor&& f
+                            ,typename boost::enable_if_<
+                             (boost::detail::function::is_assignable_functor<
+                                Functor, BOOST_FUNCTION_UNIQUE_FUNCTION>::value),
+                                        int>::type = 0
+                            ) :
+      impl_type()
+    {
+      this->assign_to(static_cast<Functor&&>(f));
+    }
+    template<typename Functor,typename Allocator>
+    BOOST_FUNCTION_UNIQUE_FUNCTION(Functor&& f, Allocator a
+                            ,typename boost::enable_if_<
+                             (boost::detail::function::is_assignable_functor<
+                                Functor, BOOST_FUNCTION_UNIQUE_FUNCTION>::value),
+                                        int>::type = 0
+                            ) :
+      impl_type()
+    {
+      this->assign_to_a(static_cast<Functor&&>(f),a);
+    }
 
+    BOOST_FUNCTION_UNIQUE_FUNCTION(clear_type*) : impl_type() {}
+
+    BOOST_FUNCTION_UNIQUE_FUNCTION(BOOST_FUNCTION_UNIQUE_FUNCTION&& f) BOOST_NOEXCEPT
+      : impl_type()
+    {
+      this->move_assign(f);
+    }
+
+    BOOST_DELETED_FUNCTION(BOOST_FUNCTION_UNIQUE_FUNCTION(const BOOST_FUNCTION_UNIQUE_FUNCTION&))
+    BOOST_DELETED_FUNCTION(BOOST_FUNCTION_UNIQUE_FUNCTION& operator=(const BOOST_FUNCTION_UNIQUE_FUNCTION&))
+
+    template<typename Functor>
+    typename boost::enable_if_<
+                  (boost::detail::function::is_assignable_functor<
+                     Functor, BOOST_FUNCTION_UNIQUE_FUNCTION>::value),
+               BOOST_FUNCTION_UNIQUE_FUNCTION&>::type
+    operator=(Functor&& f)
+    {
       this->clear();
-      BOOST_TRY {
-        this->assign_to_own(f);
+      BOOST_TRY  {
+        this->assign_to(static_cast<Functor&&>(f));
       } BOOST_CATCH (...) {
-        vtable = 0;
+        this->set_empty();
         BOOST_RETHROW;
       }
       BOOST_CATCH_END
       return *this;
     }
-
-#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
-    // Move assignment from another BOOST_FUNCTION_FUNCTION
-    BOOST_FUNCTION_FUNCTION& operator=(BOOST_FUNCTION_FUNCTION&& f)
+    template<typename Functor,typename Allocator>
+    void assign(Functor&& f, Allocator a)
     {
-      if (&f == this)
-        return *this;
-
       this->clear();
-      BOOST_TRY {
-        this->move_assign(f);
+      BOOST_TRY{
+        this->assign_to_a(static_cast<Functor&&>(f),a);
       } BOOST_CATCH (...) {
-        vtable = 0;
+        this->set_empty();
         BOOST_RETHROW;
       }
       BOOST_CATCH_END
-      return *this;
     }
-#endif
 
-    void swap(BOOST_FUNCTION_FUNCTION& other)
+    BOOST_FUNCTION_UNIQUE_FUNCTION& operator=(clear_type*)
     {
-      if (&other == this)
-        return;
-
-      BOOST_FUNCTION_FUNCTION tmp;
-      tmp.move_assign(*this);
-      this->move_assign(other);
-      other.move_assign(tmp);
+      this->clear();
+      return *this;
     }
 
-    // Clear out a target, if there is one
-    void clear()
+    BOOST_FUNCTION_UNIQUE_FUNCTION& operator=(BOOST_FUNCTION_UNIQUE_FUNCTION&& f) BOOST_NOEXCEPT
     {
-      if (vtable) {
-        if (!this->has_trivial_copy_and_destroy())
-          get_vtable()->clear(this->functor);
-        vtable = 0;
+      if (&f != this) {
+        this->clear();
+        this->move_assign(f);
       }
+      return *this;
     }
 
-#if (defined __SUNPRO_CC) && (__SUNPRO_CC <= 0x530) && !(defined BOOST_NO_COMPILER_CONFIG)
-    // Sun C++ 5.3 can't handle the safe_bool idiom, so don't use it
-    operator bool () const { return !this->empty(); }
+    void swap(BOOST_FUNCTION_UNIQUE_FUNCTION& other) BOOST_NOEXCEPT
+    {
+      this->swap_targets(other);
+    }
+  };
+
+  template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS,
+           typename Storage>
+  inline void swap(BOOST_FUNCTION_UNIQUE_FUNCTION<
+                     R BOOST_FUNCTION_COMMA
+                     BOOST_FUNCTION_TEMPLATE_ARGS,
+                     Storage
+                   >& f1,
+                   BOOST_FUNCTION_UNIQUE_FUNCTION<
+                     R BOOST_FUNCTION_COMMA
+                     BOOST_FUNCTION_TEMPLATE_ARGS,
+                     Storage
+                   >& f2) BOOST_NOEXCEPT
+  {
+    f1.swap(f2);
+  }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+  // A non-owning reference to a callable, for parameters that are only
+  // called before the callee returns. It is two words: a pointer to the
+  // function object (or member pointer), or a function pointer, and an
+  // invoker that takes it. It never allocates and is trivially copyable.
+  // The callable must outlive it, and so must a member pointer, which is
+  // referenced like a function object.
+  template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
+  class BOOST_FUNCTION_FUNCTION_REF
+  {
+  public:
+#ifndef BOOST_NO_VOID_RETURNS
+    typedef R         result_type;
 #else
-  private:
-    struct dummy {
-      void nonnull() {}
-    };
+    typedef  typename boost::detail::function::function_return_type<R>::type
+      result_type;
+#endif // BOOST_NO_VOID_RETURNS
 
-    typedef void (dummy::*safe_bool)();
+  private:
+    typedef result_type (*invoker_type)(boost::detail::function::function_ref_target
+                                        BOOST_FUNCTION_COMMA
+                                        BOOST_FUNCTION_TEMPLATE_ARGS);
 
   public:
-    operator safe_bool () const
-      { return (this->empty())? 0 : &dummy::nonnull; }
+    BOOST_STATIC_CONSTANT(int, args = BOOST_FUNCTION_NUM_ARGS);
 
-    bool operator!() const
-      { return this->empty(); }
+#if BOOST_FUNCTION_NUM_ARGS == 1
+    typedef T0 argument_type;
+#elif BOOST_FUNCTION_NUM_ARGS == 2
+    typedef T0 first_argument_type;
+    typedef T1 second_argument_type;
 #endif
 
-  private:
-    void assign_to_own(const BOOST_FUNCTION_FUNCTION& f)
+    BOOST_STATIC_CONSTANT(int, arity = BOOST_FUNCTION_NUM_ARGS);
+    BOOST_FUNCTION_ARG_TYPES
+
+    typedef BOOST_FUNCTION_FUNCTION_REF self_type;
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    template<typename Functor>
+    BOOST_FUNCTION_FUNCTION_REF(Functor&& f
+                            ,typename boost::enable_if_<
+                             (boost::detail::function::is_assignable_functor<
+                                Functor, BOOST_FUNCTION_FUNCTION_REF>::value),
+                                        int>::type = 0
+                            )
     {
-      if (!f.empty()) {
-        this->vtable = f.vtable;
-        if (this->has_trivial_copy_and_destroy()) {
-          // Don't operate on storage directly since union type doesn't relax
-          // strict aliasing rules, despite of having member char type.
-#         if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
-#           pragma GCC diagnostic push
-            // This warning is technically correct, but we don't want to pay the price for initializing
-            // just to silence a warning: https://github.com/boostorg/function/issues/27
-#           pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-#         endif
-          std::memcpy(this->functor.data, f.functor.data, sizeof(boost::detail::function::function_buffer));
-#         if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
-#           pragma GCC diagnostic pop
-#         endif
-        } else
-          get_vtable()->base.manager(f.functor, this->functor,
-                                     boost::detail::function::clone_functor_tag);
-      }
+      typedef typename decay<Functor>::type functor_type;
+      this->bind(f, typename boost::detail::function::get_function_tag<functor_type>::type());
     }
-
+#else
     template<typename Functor>
-    void assign_to(Functor f)
+    BOOST_FUNCTION_FUNCTION_REF(Functor& f
+#ifndef BOOST_NO_SFINAE
+                            ,typename boost::enable_if_<
+                             (boost::detail::function::is_assignable_functor<
+                                Functor, BOOST_FUNCTION_FUNCTION_REF>::value),
+                                        int>::type = 0
+#endif // BOOST_NO_SFINAE
+                            )
+    {
+      typedef typename decay<Functor>::type functor_type;
+      this->bind(f, typename boost::detail::function::get_function_tag<functor_type>::type());
+    }
+    template<typename Functor>
+    BOOST_FUNCTION_FUNCTION_REF(const Functor& f
+#ifndef BOOST_NO_SFINAE
+                            ,typename boost::enable_if_<
+                             (boost::detail::function::is_assignable_functor<
+                                Functor, BOOST_FUNCTION_FUNCTION_REF>::value),
+                                        int>::type = 0
+#endif // BOOST_NO_SFINAE
+                            )
     {
-      using boost::detail::function::vtable_base;
-
-      typedef typename boost::detail::function::get_function_tag<Functor>::type tag;
-      typedef boost::detail::function::BOOST_FUNCTION_GET_INVOKER<tag> get_invoker;
-      typedef typename get_invoker::
-                         template apply<Functor, R BOOST_FUNCTION_COMMA
-                        BOOST_FUNCTION_TEMPLATE_ARGS>
-        handler_type;
-
-      typedef typename handler_type::invoker_type invoker_type;
-      typedef typename handler_type::manager_type manager_type;
-
-      // Note: it is extremely important that this initialization use
-      // static initialization. Otherwise, we will have a race
-      // condition here in multi-threaded code. See
-      // http://thread.gmane.org/gmane.comp.lib.boost.devel/164902/.
-      static const vtable_type stored_vtable =
-        { { &manager_type::manage }, &invoker_type::invoke };
-
-      if (stored_vtable.assign_to(f, functor)) {
-        std::size_t value = reinterpret_cast<std::size_t>(&stored_vtable.base);
-        // coverity[pointless_expression]: suppress coverity warnings on apparant if(const).
-        if (boost::has_trivial_copy_constructor<Functor>::value &&
-            boost::has_trivial_destructor<Functor>::value &&
-            boost::detail::function::function_allows_small_object_optimization<Functor>::value)
-          value |= static_cast<std::size_t>(0x01);
-        vtable = reinterpret_cast<boost::detail::function::vtable_base *>(value);
-      } else
-        vtable = 0;
+      typedef typename decay<Functor>::type functor_type;
+      this->bind(f, typename boost::detail::function::get_function_tag<functor_type>::type());
     }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
 
-    template<typename Functor,typename Allocator>
-    void assign_to_a(Functor f,Allocator a)
+    result_type operator()(BOOST_FUNCTION_PARMS) const
     {
-      using boost::detail::function::vtable_base;
-
-      typedef typename boost::detail::function::get_function_tag<Functor>::type tag;
-      typedef boost::detail::function::BOOST_FUNCTION_GET_INVOKER<tag> get_invoker;
-      typedef typename get_invoker::
-                         template apply_a<Functor, Allocator, R BOOST_FUNCTION_COMMA
-                         BOOST_FUNCTION_TEMPLATE_ARGS>
-        handler_type;
-
-      typedef typename handler_type::invoker_type invoker_type;
-      typedef typename handler_type::manager_type manager_type;
-
-      // Note: it is extremely important that this initialization use
-      // static initialization. Otherwise, we will have a race
-      // condition here in multi-threaded code. See
-      // http://thread.gmane.org/gmane.comp.lib.boost.devel/164902/.
-      static const vtable_type stored_vtable =
-        { { &manager_type::manage }, &invoker_type::invoke };
-
-      if (stored_vtable.assign_to_a(f, functor, a)) {
-        std::size_t value = reinterpret_cast<std::size_t>(&stored_vtable.base);
-        // coverity[pointless_expression]: suppress coverity warnings on apparant if(const).
-        if (boost::has_trivial_copy_constructor<Functor>::value &&
-            boost::has_trivial_destructor<Functor>::value &&
-            boost::detail::function::function_allows_small_object_optimization<Functor>::value)
-          value |= static_cast<std::size_t>(0x01);
-        vtable = reinterpret_cast<boost::detail::function::vtable_base *>(value);
-      } else
-        vtable = 0;
+      return invoker(target BOOST_FUNCTION_COMMA BOOST_FUNCTION_ARGS);
     }
 
-    // Moves the value from the specified argument to *this. If the argument
-    // has its function object allocated on the heap, move_assign will pass
-    // its buffer to *this, and set the argument's buffer pointer to NULL.
-    void move_assign(BOOST_FUNCTION_FUNCTION& f)
+  private:
+    // Function pointers, and references to functions
+    template<typename F>
+    void bind(F& f, boost::detail::function::function_ptr_tag)
     {
-      if (&f == this)
-        return;
+      typedef typename decay<F>::type FunctionPtr;
+      typedef typename conditional<(is_void<R>::value),
+                         boost::detail::function::BOOST_FUNCTION_VOID_REF_FUNCTION_INVOKER<
+                           FunctionPtr, R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>,
+                         boost::detail::function::BOOST_FUNCTION_REF_FUNCTION_INVOKER<
+                           FunctionPtr, R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>
+                       >::type
+        ref_invoker_type;
+
+      // should be a reinterpret cast, but some compilers insist
+      // on giving cv-qualifiers to free functions
+      target.func_ptr = reinterpret_cast<void (*)()>(static_cast<FunctionPtr>(f));
+      invoker = &ref_invoker_type::invoke;
+    }
 
-      BOOST_TRY {
-        if (!f.empty()) {
-          this->vtable = f.vtable;
-          if (this->has_trivial_copy_and_destroy()) {
-            // Don't operate on storage directly since union type doesn't relax
-            // strict aliasing rules, despite of having member char type.
-#           if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
-#             pragma GCC diagnostic push
-              // This warning is technically correct, but we don't want to pay the price for initializing
-              // just to silence a warning: https://github.com/boostorg/function/issues/27
-#             pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-#           endif
-            std::memcpy(this->functor.data, f.functor.data, sizeof(this->functor.data));
-#           if defined(BOOST_GCC) && (BOOST_GCC >= 40700)
-#             pragma GCC diagnostic pop
-#           endif
-          } else
-            get_vtable()->base.manager(f.functor, this->functor,
-                                     boost::detail::function::move_functor_tag);
-          f.vtable = 0;
-        } else {
-          clear();
-        }
-      } BOOST_CATCH (...) {
-        vtable = 0;
-        BOOST_RETHROW;
-      }
-      BOOST_CATCH_END
+    // Function objects, referenced in place. F may be const-qualified.
+    template<typename F>
+    void bind(F& f, boost::detail::function::function_obj_tag)
+    {
+      typedef typename conditional<(is_void<R>::value),
+                         boost::detail::function::BOOST_FUNCTION_VOID_REF_OBJ_INVOKER<
+                           F, R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>,
+                         boost::detail::function::BOOST_FUNCTION_REF_OBJ_INVOKER<
+                           F, R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>
+                       >::type
+        ref_invoker_type;
+
+      target.obj_ptr = const_cast<void*>(static_cast<const volatile void*>(boost::addressof(f)));
+      invoker = &ref_invoker_type::invoke;
     }
+
+    // boost::ref and boost::cref refer to their referent directly
+    template<typename F>
+    void bind(const reference_wrapper<F>& f, boost::detail::function::function_obj_ref_tag)
+    {
+      this->bind(f.get(), boost::detail::function::function_obj_tag());
+    }
+
+#if BOOST_FUNCTION_NUM_ARGS > 0
+    // Member pointers are referenced in place, like function objects
+    template<typename F>
+    void bind(F& f, boost::detail::function::member_ptr_tag)
+    {
+      typedef typename decay<F>::type MemberPtr;
+      typedef typename conditional<(is_void<R>::value),
+                         boost::detail::function::BOOST_FUNCTION_VOID_REF_MEMBER_INVOKER<
+                           MemberPtr, R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>,
+                         boost::detail::function::BOOST_FUNCTION_REF_MEMBER_INVOKER<
+                           MemberPtr, R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>
+                       >::type
+        ref_invoker_type;
+
+      target.obj_ptr = const_cast<void*>(static_cast<const volatile void*>(boost::addressof(f)));
+      invoker = &ref_invoker_type::invoke;
+    }
+#endif // BOOST_FUNCTION_NUM_ARGS > 0
+
+    boost::detail::function::function_ref_target target;
+    invoker_type invoker;
   };
 
-  template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
-  inline void swap(BOOST_FUNCTION_FUNCTION<
-                     R BOOST_FUNCTION_COMMA
-                     BOOST_FUNCTION_TEMPLATE_ARGS
-                   >& f1,
-                   BOOST_FUNCTION_FUNCTION<
-                     R BOOST_FUNCTION_COMMA
-                     BOOST_FUNCTION_TEMPLATE_ARGS
-                   >& f2)
+#if !defined(BOOST_FUNCTION_NO_FUNCTION_TYPE_SYNTAX)
+
+#if BOOST_FUNCTION_NUM_ARGS == 0
+#define BOOST_FUNCTION_PARTIAL_SPEC R (void)
+#else
+#define BOOST_FUNCTION_PARTIAL_SPEC R (BOOST_FUNCTION_TEMPLATE_ARGS)
+#endif
+
+template<typename R BOOST_FUNCTION_COMMA
+         BOOST_FUNCTION_TEMPLATE_PARMS>
+class function<BOOST_FUNCTION_PARTIAL_SPEC>
+  : public BOOST_FUNCTION_FUNCTION<R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>
+{
+  typedef BOOST_FUNCTION_FUNCTION<R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS> base_type;
+  typedef function self_type;
+
+  struct clear_type {};
+
+public:
+
+  BOOST_DEFAULTED_FUNCTION(function(), : base_type() {})
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  template<typename Functor>
+  function(Functor&& f
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
+           ) :
+    base_type(static_cast<Functor&&>(f))
+  {
+  }
+  template<typename Functor,typename Allocator>
+  function(Functor&& f, Allocator a
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
+           ) :
+    base_type(static_cast<Functor&&>(f),a)
+  {
+  }
+#else
+  template<typename Functor>
+  function(Functor f
+#ifndef BOOST_NO_SFINAE
+           ,typename boost::enable_if_<
+                          !(is_integral<Functor>::value),
+                       int>::type = 0
+#endif
+           ) :
+    base_type(f)
+  {
+  }
+  template<typename Functor,typename Allocator>
+  function(Functor f, Allocator a
+#ifndef BOOST_NO_SFINAE
+           ,typename boost::enable_if_<
+                           !(is_integral<Functor>::value),
+                       int>::type = 0
+#endif
+           ) :
+    base_type(f,a)
+  {
+  }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+#ifndef BOOST_NO_SFINAE
+  function(clear_type*) : base_type() {}
+#endif
+
+  function(const self_type& f) : base_type(static_cast<const base_type&>(f)){}
+
+  function(const base_type& f) : base_type(static_cast<const base_type&>(f)){}
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  // Move constructors
+  function(self_type&& f) BOOST_NOEXCEPT : base_type(static_cast<base_type&&>(f)){}
+  function(base_type&& f) BOOST_NOEXCEPT : base_type(static_cast<base_type&&>(f)){}
+#endif
+
+  self_type& operator=(const self_type& f)
+  {
+    self_type(f).swap(*this);
+    return *this;
+  }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  self_type& operator=(self_type&& f) BOOST_NOEXCEPT
+  {
+    self_type(static_cast<self_type&&>(f)).swap(*this);
+    return *this;
+  }
+#endif
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  template<typename Functor>
+  typename boost::enable_if_<
+                         (boost::detail::function::is_assignable_functor<
+                            Functor, self_type, base_type>::value),
+                      self_type&>::type
+  operator=(Functor&& f)
+  {
+    self_type(static_cast<Functor&&>(f)).swap(*this);
+    return *this;
+  }
+#else
+  template<typename Functor>
+#ifndef BOOST_NO_SFINAE
+  typename boost::enable_if_<
+                         !(is_integral<Functor>::value),
+                      self_type&>::type
+#else
+  self_type&
+#endif
+  operator=(Functor f)
   {
-    f1.swap(f2);
+    self_type(f).swap(*this);
+    return *this;
   }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
 
-// Poison comparisons between boost::function objects of the same type.
-template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
-  void operator==(const BOOST_FUNCTION_FUNCTION<
-                          R BOOST_FUNCTION_COMMA
-                          BOOST_FUNCTION_TEMPLATE_ARGS>&,
-                  const BOOST_FUNCTION_FUNCTION<
-                          R BOOST_FUNCTION_COMMA
-                          BOOST_FUNCTION_TEMPLATE_ARGS>&);
-template<typename R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_PARMS>
-  void operator!=(const BOOST_FUNCTION_FUNCTION<
-                          R BOOST_FUNCTION_COMMA
-                          BOOST_FUNCTION_TEMPLATE_ARGS>&,
-                  const BOOST_FUNCTION_FUNCTION<
-                          R BOOST_FUNCTION_COMMA
-                          BOOST_FUNCTION_TEMPLATE_ARGS>& );
+#ifndef BOOST_NO_SFINAE
+  self_type& operator=(clear_type*)
+  {
+    this->clear();
+    return *this;
+  }
+#endif
 
-#if !defined(BOOST_FUNCTION_NO_FUNCTION_TYPE_SYNTAX)
+  self_type& operator=(const base_type& f)
+  {
+    self_type(f).swap(*this);
+    return *this;
+  }
 
-#if BOOST_FUNCTION_NUM_ARGS == 0
-#define BOOST_FUNCTION_PARTIAL_SPEC R (void)
-#else
-#define BOOST_FUNCTION_PARTIAL_SPEC R (BOOST_FUNCTION_TEMPLATE_ARGS)
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  self_type& operator=(base_type&& f) BOOST_NOEXCEPT
+  {
+    self_type(static_cast<base_type&&>(f)).swap(*this);
+    return *this;
+  }
 #endif
+};
 
+// Like function, but small function objects of up to Capacity bytes
+// with an alignment dividing Alignment are stored without allocating.
 template<typename R BOOST_FUNCTION_COMMA
-         BOOST_FUNCTION_TEMPLATE_PARMS>
-class function<BOOST_FUNCTION_PARTIAL_SPEC>
-  : public BOOST_FUNCTION_FUNCTION<R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>
+         BOOST_FUNCTION_TEMPLATE_PARMS,
+         std::size_t Capacity, std::size_t Alignment>
+class basic_function<BOOST_FUNCTION_PARTIAL_SPEC, Capacity, Alignment>
+  : public boost::detail::function::BOOST_FUNCTION_BASIC_FUNCTION<
+             R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS,
+             boost::detail::function::function_storage<Capacity, Alignment> >
 {
-  typedef BOOST_FUNCTION_FUNCTION<R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS> base_type;
-  typedef function self_type;
+  typedef boost::detail::function::BOOST_FUNCTION_BASIC_FUNCTION<
+            R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS,
+            boost::detail::function::function_storage<Capacity, Alignment> >
+    base_type;
+  typedef basic_function self_type;
 
   struct clear_type {};
 
 public:
 
-  BOOST_DEFAULTED_FUNCTION(function(), : base_type() {})
+  BOOST_DEFAULTED_FUNCTION(basic_function(), : base_type() {})
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
   template<typename Functor>
-  function(Functor f
+  basic_function(Functor&& f
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
+           ) :
+    base_type(static_cast<Functor&&>(f))
+  {
+  }
+  template<typename Functor,typename Allocator>
+  basic_function(Functor&& f, Allocator a
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
+           ) :
+    base_type(static_cast<Functor&&>(f),a)
+  {
+  }
+#else
+  template<typename Functor>
+  basic_function(Functor f
 #ifndef BOOST_NO_SFINAE
            ,typename boost::enable_if_<
                           !(is_integral<Functor>::value),
@@ -1087,7 +2218,7 @@ public:
   {
   }
   template<typename Functor,typename Allocator>
-  function(Functor f, Allocator a
+  basic_function(Functor f, Allocator a
 #ifndef BOOST_NO_SFINAE
            ,typename boost::enable_if_<
                            !(is_integral<Functor>::value),
@@ -1097,19 +2228,20 @@ public:
     base_type(f,a)
   {
   }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
 
 #ifndef BOOST_NO_SFINAE
-  function(clear_type*) : base_type() {}
+  basic_function(clear_type*) : base_type() {}
 #endif
 
-  function(const self_type& f) : base_type(static_cast<const base_type&>(f)){}
+  basic_function(const self_type& f) : base_type(static_cast<const base_type&>(f)){}
 
-  function(const base_type& f) : base_type(static_cast<const base_type&>(f)){}
+  basic_function(const base_type& f) : base_type(static_cast<const base_type&>(f)){}
 
 #ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
   // Move constructors
-  function(self_type&& f): base_type(static_cast<base_type&&>(f)){}
-  function(base_type&& f): base_type(static_cast<base_type&&>(f)){}
+  basic_function(self_type&& f) BOOST_NOEXCEPT : base_type(static_cast<base_type&&>(f)){}
+  basic_function(base_type&& f) BOOST_NOEXCEPT : base_type(static_cast<base_type&&>(f)){}
 #endif
 
   self_type& operator=(const self_type& f)
@@ -1119,13 +2251,25 @@ public:
   }
 
 #ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
-  self_type& operator=(self_type&& f)
+  self_type& operator=(self_type&& f) BOOST_NOEXCEPT
   {
     self_type(static_cast<self_type&&>(f)).swap(*this);
     return *this;
   }
 #endif
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  template<typename Functor>
+  typename boost::enable_if_<
+                         (boost::detail::function::is_assignable_functor<
+                            Functor, self_type, base_type>::value),
+                      self_type&>::type
+  operator=(Functor&& f)
+  {
+    self_type(static_cast<Functor&&>(f)).swap(*this);
+    return *this;
+  }
+#else
   template<typename Functor>
 #ifndef BOOST_NO_SFINAE
   typename boost::enable_if_<
@@ -1139,6 +2283,7 @@ public:
     self_type(f).swap(*this);
     return *this;
   }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
 
 #ifndef BOOST_NO_SFINAE
   self_type& operator=(clear_type*)
@@ -1155,12 +2300,274 @@ public:
   }
 
 #ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
-  self_type& operator=(base_type&& f)
+  self_type& operator=(base_type&& f) BOOST_NOEXCEPT
+  {
+    self_type(static_cast<base_type&&>(f)).swap(*this);
+    return *this;
+  }
+#endif
+};
+
+// Like basic_function, but never allocates: assigning a function object
+// that does not fit in Capacity bytes with an alignment dividing
+// Alignment is a compile-time error, so the heap paths of the managers
+// are never instantiated.
+template<typename R BOOST_FUNCTION_COMMA
+         BOOST_FUNCTION_TEMPLATE_PARMS,
+         std::size_t Capacity, std::size_t Alignment>
+class inplace_function<BOOST_FUNCTION_PARTIAL_SPEC, Capacity, Alignment>
+  : public boost::detail::function::BOOST_FUNCTION_BASIC_FUNCTION<
+             R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS,
+             boost::detail::function::function_storage<Capacity, Alignment> >
+{
+  typedef boost::detail::function::function_storage<Capacity, Alignment> storage_type;
+  typedef boost::detail::function::BOOST_FUNCTION_BASIC_FUNCTION<
+            R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS, storage_type>
+    base_type;
+  typedef inplace_function self_type;
+
+  struct clear_type {};
+
+  // Every way of assigning a target goes through this check, so that no
+  // target ends up on the heap
+  template<typename Functor>
+  static void check_fit()
+  {
+    BOOST_STATIC_ASSERT_MSG((boost::detail::function::is_stored_inline<
+                               Functor, storage_type>::value),
+                            "the function object does not fit in the inplace_function");
+  }
+
+public:
+
+  BOOST_DEFAULTED_FUNCTION(inplace_function(), : base_type() {})
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  template<typename Functor>
+  inplace_function(Functor&& f
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
+           ) :
+    base_type(static_cast<Functor&&>(f))
+  {
+    check_fit<typename decay<Functor>::type>();
+  }
+#else
+  template<typename Functor>
+  inplace_function(Functor f
+#ifndef BOOST_NO_SFINAE
+           ,typename boost::enable_if_<
+                          !(is_integral<Functor>::value),
+                       int>::type = 0
+#endif
+           ) :
+    base_type(f)
+  {
+    check_fit<Functor>();
+  }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+#ifndef BOOST_NO_SFINAE
+  inplace_function(clear_type*) : base_type() {}
+#endif
+
+  inplace_function(const self_type& f) : base_type(static_cast<const base_type&>(f)){}
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  inplace_function(self_type&& f) BOOST_NOEXCEPT : base_type(static_cast<base_type&&>(f)){}
+#endif
+
+  self_type& operator=(const self_type& f)
+  {
+    self_type(f).swap(*this);
+    return *this;
+  }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  self_type& operator=(self_type&& f) BOOST_NOEXCEPT
+  {
+    self_type(static_cast<self_type&&>(f)).swap(*this);
+    return *this;
+  }
+#endif
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  template<typename Functor>
+  typename boost::enable_if_<
+                         (boost::detail::function::is_assignable_functor<
+                            Functor, self_type, base_type>::value),
+                      self_type&>::type
+  operator=(Functor&& f)
+  {
+    check_fit<typename decay<Functor>::type>();
+    self_type(static_cast<Functor&&>(f)).swap(*this);
+    return *this;
+  }
+
+  template<typename Functor,typename Allocator>
+  void assign(Functor&& f, Allocator a)
+  {
+    check_fit<typename decay<Functor>::type>();
+    base_type::assign(static_cast<Functor&&>(f), a);
+  }
+#else
+  template<typename Functor>
+#ifndef BOOST_NO_SFINAE
+  typename boost::enable_if_<
+                         !(is_integral<Functor>::value),
+                      self_type&>::type
+#else
+  self_type&
+#endif
+  operator=(Functor f)
+  {
+    check_fit<Functor>();
+    self_type(f).swap(*this);
+    return *this;
+  }
+
+  template<typename Functor,typename Allocator>
+  void assign(Functor f, Allocator a)
+  {
+    check_fit<Functor>();
+    base_type::assign(f, a);
+  }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+#ifndef BOOST_NO_SFINAE
+  self_type& operator=(clear_type*)
+  {
+    this->clear();
+    return *this;
+  }
+#endif
+};
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+// Like function, but move-only, so that it can hold move-only targets
+template<typename R BOOST_FUNCTION_COMMA
+         BOOST_FUNCTION_TEMPLATE_PARMS>
+class unique_function<BOOST_FUNCTION_PARTIAL_SPEC>
+  : public BOOST_FUNCTION_UNIQUE_FUNCTION<R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>
+{
+  typedef BOOST_FUNCTION_UNIQUE_FUNCTION<R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS> base_type;
+  typedef unique_function self_type;
+
+  struct clear_type {};
+
+public:
+
+  BOOST_DEFAULTED_FUNCTION(unique_function(), : base_type() {})
+
+  template<typename Functor>
+  unique_function(Functor&& f
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
+           ) :
+    base_type(static_cast<Functor&&>(f))
+  {
+  }
+  template<typename Functor,typename Allocator>
+  unique_function(Functor&& f, Allocator a
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
+           ) :
+    base_type(static_cast<Functor&&>(f),a)
+  {
+  }
+
+  unique_function(clear_type*) : base_type() {}
+
+  // Move constructors
+  unique_function(self_type&& f) BOOST_NOEXCEPT : base_type(static_cast<base_type&&>(f)){}
+  unique_function(base_type&& f) BOOST_NOEXCEPT : base_type(static_cast<base_type&&>(f)){}
+
+  self_type& operator=(self_type&& f) BOOST_NOEXCEPT
+  {
+    self_type(static_cast<self_type&&>(f)).swap(*this);
+    return *this;
+  }
+
+  template<typename Functor>
+  typename boost::enable_if_<
+                         (boost::detail::function::is_assignable_functor<
+                            Functor, self_type, base_type>::value),
+                      self_type&>::type
+  operator=(Functor&& f)
+  {
+    self_type(static_cast<Functor&&>(f)).swap(*this);
+    return *this;
+  }
+
+  self_type& operator=(clear_type*)
+  {
+    this->clear();
+    return *this;
+  }
+
+  self_type& operator=(base_type&& f) BOOST_NOEXCEPT
   {
     self_type(static_cast<base_type&&>(f)).swap(*this);
     return *this;
   }
+};
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+// Non-owning reference to a callable with the given signature
+template<typename R BOOST_FUNCTION_COMMA
+         BOOST_FUNCTION_TEMPLATE_PARMS>
+class function_ref<BOOST_FUNCTION_PARTIAL_SPEC>
+  : public BOOST_FUNCTION_FUNCTION_REF<R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS>
+{
+  typedef BOOST_FUNCTION_FUNCTION_REF<R BOOST_FUNCTION_COMMA BOOST_FUNCTION_TEMPLATE_ARGS> base_type;
+  typedef function_ref self_type;
+
+public:
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  template<typename Functor>
+  function_ref(Functor&& f
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
+           ) :
+    base_type(static_cast<Functor&&>(f))
+  {
+  }
+#else
+  template<typename Functor>
+  function_ref(Functor& f
+#ifndef BOOST_NO_SFINAE
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
+#endif
+           ) :
+    base_type(f)
+  {
+  }
+  template<typename Functor>
+  function_ref(const Functor& f
+#ifndef BOOST_NO_SFINAE
+           ,typename boost::enable_if_<
+                          (boost::detail::function::is_assignable_functor<
+                             Functor, self_type, base_type>::value),
+                       int>::type = 0
 #endif
+           ) :
+    base_type(f)
+  {
+  }
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+  function_ref(const base_type& f) : base_type(f) {}
 };
 
 #undef BOOST_FUNCTION_PARTIAL_SPEC
@@ -1172,14 +2579,27 @@ public:
 #undef BOOST_FUNCTION_VTABLE
 #undef BOOST_FUNCTION_COMMA
 #undef BOOST_FUNCTION_FUNCTION
+#undef BOOST_FUNCTION_UNIQUE_FUNCTION
+#undef BOOST_FUNCTION_FUNCTION_REF
+#undef BOOST_FUNCTION_FUNCTION_IMPL
+#undef BOOST_FUNCTION_BASIC_FUNCTION
 #undef BOOST_FUNCTION_FUNCTION_INVOKER
 #undef BOOST_FUNCTION_VOID_FUNCTION_INVOKER
 #undef BOOST_FUNCTION_FUNCTION_OBJ_INVOKER
 #undef BOOST_FUNCTION_VOID_FUNCTION_OBJ_INVOKER
 #undef BOOST_FUNCTION_FUNCTION_REF_INVOKER
 #undef BOOST_FUNCTION_VOID_FUNCTION_REF_INVOKER
+#undef BOOST_FUNCTION_REF_FUNCTION_INVOKER
+#undef BOOST_FUNCTION_VOID_REF_FUNCTION_INVOKER
+#undef BOOST_FUNCTION_REF_OBJ_INVOKER
+#undef BOOST_FUNCTION_VOID_REF_OBJ_INVOKER
+#undef BOOST_FUNCTION_REF_MEMBER_INVOKER
+#undef BOOST_FUNCTION_VOID_REF_MEMBER_INVOKER
 #undef BOOST_FUNCTION_MEMBER_INVOKER
 #undef BOOST_FUNCTION_VOID_MEMBER_INVOKER
+#undef BOOST_FUNCTION_DELEGATE_INVOKER
+#undef BOOST_FUNCTION_VOID_DELEGATE_INVOKER
+#undef BOOST_FUNCTION_GET_DELEGATE_INVOKER
 #undef BOOST_FUNCTION_GET_FUNCTION_INVOKER
 #undef BOOST_FUNCTION_GET_FUNCTION_OBJ_INVOKER
 #undef BOOST_FUNCTION_GET_FUNCTION_REF_INVOKER
@@ -0,0 +1,406 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#ifndef BOOST_FUNCTION_FUNCTION_TIMER_WHEEL_HPP
+#define BOOST_FUNCTION_FUNCTION_TIMER_WHEEL_HPP
+
+#include <boost/function.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/core/no_exceptions_support.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace boost {
+  namespace detail {
+    namespace function {
+      // The index of the lowest set bit of x, which is not 0
+      inline unsigned lowest_bit(boost::uint64_t x)
+      {
+#if defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        for (; !(x & 1); x >>= 1)
+          ++n;
+        return n;
+#endif
+      }
+    } // end namespace function
+  } // end namespace detail
+
+/**
+ * Calls boost::function<void()> callbacks once a tick count is reached,
+ * as timeouts do. The clock is driven by the owner through advance_to(),
+ * so a tick can be any unit of time.
+ *
+ * Timers are kept in a hierarchical wheel of 6 levels of 64 slots, each
+ * level covering 64 times the span of the one below: scheduling and
+ * cancelling a timer take constant time, and a timer moves down at most
+ * once per level before it expires. Timers are intrusive nodes, each
+ * embedding its boost::function, taken from pools of nodes that are
+ * reused, so that scheduling allocates nothing once enough nodes exist
+ * and the callbacks fit in the small-object buffer. Timers further
+ * than 2^36 ticks away wait in the last level until they come closer.
+ *
+ * Not thread-safe. Callbacks may schedule and cancel timers, but not
+ * advance the wheel.
+ */
+class function_timer_wheel
+{
+public:
+  typedef boost::uint64_t tick_type;
+  typedef boost::function<void()> function_type;
+
+private:
+  struct link
+  {
+    link* prev;
+    link* next;
+  };
+
+  struct node : link
+  {
+    node() : expiry(0), generation(0) {}
+
+    function_type callback;
+    tick_type expiry;
+    unsigned generation;
+  };
+
+public:
+  /**
+   * Identifies a scheduled timer. It becomes stale once the timer has
+   * expired or has been cancelled, even if its node is reused.
+   */
+  class timer
+  {
+  public:
+    timer() : n(0), generation(0) {}
+
+  private:
+    friend class function_timer_wheel;
+    explicit timer(node* t) : n(t), generation(t->generation) {}
+
+    node* n;
+    unsigned generation;
+  };
+
+  explicit function_timer_wheel(tick_type now = 0) : current(now), active(0), free_nodes(0)
+  {
+    for (int level = 0; level < levels; ++level) {
+      occupied[level] = 0;
+      for (int i = 0; i < slots; ++i)
+        reset(wheel[level][i]);
+    }
+    reset(expiring);
+  }
+
+  ~function_timer_wheel()
+  {
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+      delete [] chunks[i];
+  }
+
+  /** The last tick advanced to. */
+  tick_type now() const { return current; }
+
+  /** The number of scheduled timers. */
+  std::size_t size() const { return active; }
+
+  bool empty() const { return active == 0; }
+
+  /** Create nodes up to n timers, so that scheduling them allocates none. */
+  void reserve(std::size_t n)
+  {
+    std::size_t available = active;
+    for (link* l = free_nodes; l; l = l->next)
+      ++available;
+    while (available < n) {
+      grow();
+      available += chunk_size;
+    }
+  }
+
+  /**
+   * Call f at the first advance_to() reaching when, or at the next one
+   * if when has been reached already. Empty functions are scheduled, and
+   * do nothing when they expire.
+   */
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  template<typename F>
+  timer schedule_at(tick_type when, F&& f)
+  {
+    node* n = allocate();
+    BOOST_TRY {
+      n->callback = static_cast<F&&>(f);
+    } BOOST_CATCH(...) {
+      deallocate(n);
+      BOOST_RETHROW;
+    }
+    BOOST_CATCH_END
+    return schedule(n, when);
+  }
+
+  /** Call f in delay ticks. */
+  template<typename F>
+  timer schedule_after(tick_type delay, F&& f)
+  {
+    return schedule_at(current + delay, static_cast<F&&>(f));
+  }
+#else
+  template<typename F>
+  timer schedule_at(tick_type when, const F& f)
+  {
+    node* n = allocate();
+    BOOST_TRY {
+      n->callback = f;
+    } BOOST_CATCH(...) {
+      deallocate(n);
+      BOOST_RETHROW;
+    }
+    BOOST_CATCH_END
+    return schedule(n, when);
+  }
+
+  /** Call f in delay ticks. */
+  template<typename F>
+  timer schedule_after(tick_type delay, const F& f)
+  {
+    return schedule_at(current + delay, f);
+  }
+#endif
+
+  /** Whether t is scheduled and has not expired yet. */
+  bool pending(const timer& t) const
+  {
+    return t.n && t.n->generation == t.generation;
+  }
+
+  /** Cancel t. Returns false if it was not pending. */
+  bool cancel(const timer& t)
+  {
+    if (!pending(t))
+      return false;
+    unlink(t.n);
+    --active;
+    ++t.n->generation;
+    deallocate(t.n);
+    return true;
+  }
+
+  /**
+   * Move the clock to when, calling the callbacks of the timers that
+   * expire on the way, tick by tick. Ticks in which nothing happens are
+   * skipped. Returns the number of callbacks called. If a callback
+   * throws, the exception propagates; the timers of the same tick that
+   * remain are called by the next advance_to().
+   */
+  std::size_t advance_to(tick_type when)
+  {
+    std::size_t called = expire();
+    while (current < when) {
+      if (active == 0) {
+        current = when;
+        break;
+      }
+      tick_type next = next_event();
+      if (next > when) {
+        current = when;
+        break;
+      }
+      current = next;
+      cascade();
+      splice(wheel[0][current & (slots - 1)], expiring);
+      occupied[0] &= ~(boost::uint64_t(1) << (current & (slots - 1)));
+      called += expire();
+    }
+    return called;
+  }
+
+  /** Advance the clock by ticks. */
+  std::size_t advance(tick_type ticks) { return advance_to(current + ticks); }
+
+private:
+  function_timer_wheel(const function_timer_wheel&);
+  function_timer_wheel& operator=(const function_timer_wheel&);
+
+  BOOST_STATIC_CONSTANT(int, levels = 6);
+  BOOST_STATIC_CONSTANT(int, bits = 6);
+  BOOST_STATIC_CONSTANT(int, slots = 1 << bits);
+  BOOST_STATIC_CONSTANT(std::size_t, chunk_size = 256);
+
+  static void reset(link& l) { l.prev = l.next = &l; }
+
+  static void unlink(link* l)
+  {
+    l->prev->next = l->next;
+    l->next->prev = l->prev;
+  }
+
+  static void push_back(link& list, link* l)
+  {
+    l->prev = list.prev;
+    l->next = &list;
+    list.prev->next = l;
+    list.prev = l;
+  }
+
+  // Move the nodes of from to the end of to
+  static void splice(link& from, link& to)
+  {
+    if (from.next == &from)
+      return;
+    from.next->prev = to.prev;
+    to.prev->next = from.next;
+    from.prev->next = &to;
+    to.prev = from.prev;
+    reset(from);
+  }
+
+  void grow()
+  {
+    chunks.push_back(0);
+    node* chunk = new node[chunk_size];
+    chunks.back() = chunk;
+    for (std::size_t i = 0; i < chunk_size; ++i) {
+      chunk[i].next = free_nodes;
+      free_nodes = &chunk[i];
+    }
+  }
+
+  node* allocate()
+  {
+    if (!free_nodes)
+      grow();
+    node* n = static_cast<node*>(free_nodes);
+    free_nodes = n->next;
+    return n;
+  }
+
+  void deallocate(node* n)
+  {
+    n->callback.clear();
+    n->next = free_nodes;
+    free_nodes = n;
+  }
+
+  timer schedule(node* n, tick_type when)
+  {
+    n->expiry = when > current ? when : current + 1;
+    place(n);
+    ++active;
+    return timer(n);
+  }
+
+  // Puts n in the slot of the lowest level whose span covers its expiry.
+  // A timer in level i is moved down when the clock reaches the first
+  // tick of its slot, which comes before its expiry.
+  void place(node* n)
+  {
+    tick_type delta = n->expiry - current;
+    tick_type at = n->expiry;
+    if (delta >> (levels * bits))
+      at = current + (tick_type(1) << (levels * bits)) - 1;
+
+    int level = 0;
+    while (level + 1 < levels && ((at - current) >> ((level + 1) * bits)))
+      ++level;
+    unsigned slot = static_cast<unsigned>(at >> (level * bits)) & (slots - 1);
+    push_back(wheel[level][slot], n);
+    occupied[level] |= boost::uint64_t(1) << slot;
+  }
+
+  // The first tick after current at which a slot holding timers is
+  // reached, either to be expired or to be moved down. Slots emptied by
+  // cancellations may still be counted as holding timers.
+  tick_type next_event() const
+  {
+    tick_type next = ~tick_type(0);
+    for (int level = 0; level < levels; ++level) {
+      boost::uint64_t bits_set = occupied[level];
+      if (!bits_set)
+        continue;
+      tick_type block = current >> (level * bits);
+      unsigned shift = static_cast<unsigned>(block + 1) & (slots - 1);
+      boost::uint64_t rotated = shift ? (bits_set >> shift) | (bits_set << (slots - shift))
+                                      : bits_set;
+      tick_type at = (block + 1 + detail::function::lowest_bit(rotated)) << (level * bits);
+      if (at < next)
+        next = at;
+    }
+    return next;
+  }
+
+  // Moves down the timers of the slots whose first tick is current,
+  // from the highest level
+  void cascade()
+  {
+    int top = 0;
+    while (top + 1 < levels &&
+           (current & ((tick_type(1) << ((top + 1) * bits)) - 1)) == 0)
+      ++top;
+
+    for (int level = top; level > 0; --level) {
+      unsigned slot = static_cast<unsigned>(current >> (level * bits)) & (slots - 1);
+      boost::uint64_t bit = boost::uint64_t(1) << slot;
+      if (!(occupied[level] & bit))
+        continue;
+      occupied[level] &= ~bit;
+
+      link moving;
+      reset(moving);
+      splice(wheel[level][slot], moving);
+      while (moving.next != &moving) {
+        node* n = static_cast<node*>(moving.next);
+        unlink(n);
+        place(n);
+      }
+    }
+  }
+
+  // Calls the timers in expiring, which have expired
+  std::size_t expire()
+  {
+    std::size_t called = 0;
+    while (expiring.next != &expiring) {
+      node* n = static_cast<node*>(expiring.next);
+      unlink(n);
+      --active;
+      ++n->generation;
+
+      releaser r(*this, n);
+      if (!n->callback.empty()) {
+        n->callback();
+        ++called;
+      }
+    }
+    return called;
+  }
+
+  // Puts a called node back in the pool, even if its callback throws
+  struct releaser
+  {
+    releaser(function_timer_wheel& w, node* called) : wheel(w), n(called) {}
+    ~releaser() { wheel.deallocate(n); }
+
+    function_timer_wheel& wheel;
+    node* n;
+  };
+
+  tick_type current;
+  std::size_t active;
+  link wheel[levels][slots];
+  boost::uint64_t occupied[levels];
+  link expiring;
+  link* free_nodes;
+  std::vector<node*> chunks;
+};
+
+} // end namespace boost
+
+#endif // BOOST_FUNCTION_FUNCTION_TIMER_WHEEL_HPP
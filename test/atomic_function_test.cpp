@@ -0,0 +1,161 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function/atomic_function.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_HDR_THREAD) && \
+    !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) && \
+    !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static std::atomic<int> live(0);
+
+// Counts its live copies, and checks that it is not called once destroyed
+struct add
+{
+  explicit add(int v): value(v), alive(true) { ++live; }
+  add(const add& other): value(other.value), alive(true) { ++live; }
+  ~add() { alive = false; --live; }
+
+  int operator()(int x) const
+  {
+    BOOST_TEST(alive);
+    return value + x;
+  }
+
+  int value;
+  volatile bool alive;
+};
+
+static int twice(int x) { return 2 * x; }
+
+static boost::atomic_function<int (int)> nested(&twice);
+
+struct call_nested
+{
+  int operator()(int x) const { return nested(x) + 1; }
+};
+
+int main()
+{
+  typedef boost::atomic_function<int (int)> atomic_function;
+
+  // Single-threaded use
+  {
+    atomic_function f;
+    BOOST_TEST(f.empty());
+    BOOST_TEST_THROWS(f(1), boost::bad_function_call);
+
+    f.store(add(1));
+    BOOST_TEST(!f.empty());
+    BOOST_TEST_EQ(f(1), 2);
+
+    f.store(&twice);
+    BOOST_TEST_EQ(f(3), 6);
+
+    boost::function<int (int)> g = f.load();
+    BOOST_TEST_EQ(g(4), 8);
+
+    f.clear();
+    BOOST_TEST(f.empty());
+    BOOST_TEST(f.load().empty());
+
+    atomic_function h(add(2));
+    BOOST_TEST_EQ(h(1), 3);
+
+    // Calls may nest
+    atomic_function n((call_nested()));
+    BOOST_TEST_EQ(n(2), 5);
+  }
+
+  // Replaced targets are destroyed once no call can see them
+  {
+    atomic_function f(add(0));
+    for (int i = 1; i < 10; ++i)
+      f.store(add(i));
+    BOOST_TEST(live.load() <= 3);
+    BOOST_TEST_EQ(f(1), 10);
+  }
+
+  // Readers calling while a writer replaces the target
+  {
+    atomic_function f(add(0));
+    std::atomic<bool> done(false);
+    std::atomic<long> calls(0);
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+      readers.push_back(std::thread([&] {
+        while (!done.load()) {
+          int r = f(0);
+          BOOST_TEST(r >= 0 && r < 2000);
+          calls.fetch_add(1, std::memory_order_relaxed);
+        }
+      }));
+    }
+
+    while (calls.load() < 100)
+      std::this_thread::yield();
+
+    for (int i = 1; i < 2000; ++i)
+      f.store(add(i));
+    done = true;
+    for (std::size_t t = 0; t < readers.size(); ++t)
+      readers[t].join();
+
+    BOOST_TEST_EQ(f(0), 1999);
+  }
+
+  // With no reader left, further stores destroy the retired targets
+  {
+    atomic_function f(add(0));
+    for (int i = 0; i < 3; ++i)
+      f.store(add(i));
+    BOOST_TEST(live.load() <= 3);
+  }
+  BOOST_TEST(live.load() <= 2);
+
+  // A replaced target is destroyed when the first call after the store
+  // returns
+  {
+    atomic_function f(add(1));
+    f(0);
+    f(0);
+    BOOST_TEST_EQ(live.load(), 1);
+
+    f.store(add(2));
+    BOOST_TEST_EQ(live.load(), 2);
+    BOOST_TEST_EQ(f(0), 2);
+    BOOST_TEST_EQ(live.load(), 1);
+  }
+  BOOST_TEST_EQ(live.load(), 0);
+
+  // or else when the atomic_function is destroyed
+  {
+    atomic_function f(add(1));
+    f.store(add(2));
+    BOOST_TEST_EQ(live.load(), 2);
+  }
+  BOOST_TEST_EQ(live.load(), 0);
+
+  return boost::report_errors();
+}
+
+#else
+
+int main()
+{
+  return 0;
+}
+
+#endif
@@ -0,0 +1,221 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+// function_base stays a class, and the portable syntax keeps its
+// template parameters, so that both can be declared ahead
+namespace boost {
+  class function_base;
+  template<typename R, typename T1> class function1;
+}
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_base_of.hpp>
+#include <cstddef>
+#include <new>
+
+BOOST_STATIC_ASSERT((boost::is_base_of<boost::function_base, boost::function<int (int)> >::value));
+BOOST_STATIC_ASSERT((boost::is_base_of<boost::function_base, boost::function1<int, int> >::value));
+
+// Template template parameters accept the portable syntax
+template<template<typename, typename> class Function>
+struct unary
+{
+  typedef Function<long, long> type;
+};
+
+static int heap_allocations = 0;
+
+// A function object capturing Words pointer-sized values, which counts
+// how many times Boost.Function places it on the heap.
+template<int Words>
+struct capture
+{
+  explicit capture(long v)
+  {
+    for (int i = 0; i < Words; ++i)
+      values[i] = v;
+  }
+
+  long operator()(long x) const { return values[0] + values[Words - 1] + x; }
+
+  static void* operator new(std::size_t n)
+  {
+    ++heap_allocations;
+    return ::operator new(n);
+  }
+
+  static void operator delete(void* p)
+  {
+    ::operator delete(p);
+  }
+
+  static void* operator new(std::size_t, void* p) { return p; }
+  static void operator delete(void*, void*) { }
+
+  long values[Words];
+};
+
+template<int Words>
+bool operator==(const capture<Words>& x, const capture<Words>& y)
+{
+  return x.values[0] == y.values[0];
+}
+
+static long twice(long x) { return 2 * x; }
+
+// A small function object with a stricter alignment than function_buffer
+struct BOOST_ALIGNMENT(32) wide
+{
+  explicit wide(long v): value(v) {}
+  long operator()(long x) const { return value + x; }
+  long value;
+};
+
+template<typename F, typename T>
+bool stored_inline(const F& f, const T* target)
+{
+  const char* p = reinterpret_cast<const char*>(target);
+  const char* begin = reinterpret_cast<const char*>(&f);
+  return p >= begin && p < begin + sizeof(f);
+}
+
+template<typename T>
+bool is_aligned(const T* p)
+{
+  return reinterpret_cast<std::size_t>(p) % boost::alignment_of<T>::value == 0;
+}
+
+int main()
+{
+  typedef boost::basic_function<long(long), 6 * sizeof(long)> func6;
+
+  // Fits in the default buffer and in the larger one
+  {
+    heap_allocations = 0;
+    boost::function<long(long)> f = capture<2>(1);
+    func6 g = capture<2>(1);
+    BOOST_TEST_EQ(f(1), 3);
+    BOOST_TEST_EQ(g(1), 3);
+    BOOST_TEST_EQ(heap_allocations, 0);
+  }
+
+  // Only fits in the larger buffer
+  {
+    heap_allocations = 0;
+    boost::function<long(long)> f = capture<6>(2);
+    BOOST_TEST_EQ(heap_allocations, 1);
+    boost::function<long(long)> f2(f);
+    BOOST_TEST_EQ(heap_allocations, 2);
+    BOOST_TEST_EQ(f2(1), 5);
+
+    heap_allocations = 0;
+    func6 g = capture<6>(2);
+    func6 g2(g);
+    func6 g3;
+    g3 = g2;
+    BOOST_TEST_EQ(g(1), 5);
+    BOOST_TEST_EQ(g2(1), 5);
+    BOOST_TEST_EQ(g3(1), 5);
+    BOOST_TEST_EQ(heap_allocations, 0);
+
+    BOOST_TEST(g3.target<capture<6> >() != 0);
+    BOOST_TEST(g3.target<capture<2> >() == 0);
+    BOOST_TEST(g3.contains(capture<6>(2)));
+    BOOST_TEST(!g3.contains(capture<6>(3)));
+    BOOST_TEST(g3.target_type() == boost::typeindex::type_id<capture<6> >());
+  }
+
+  // Still larger targets go to the heap
+  {
+    heap_allocations = 0;
+    func6 g = capture<8>(3);
+    func6 g2(g);
+    BOOST_TEST_EQ(g2(1), 7);
+    BOOST_TEST_EQ(heap_allocations, 2);
+  }
+
+  // Allocator support
+  {
+    heap_allocations = 0;
+    func6 g(capture<6>(4), std::allocator<int>());
+    BOOST_TEST_EQ(g(0), 8);
+    func6 h(capture<8>(4), std::allocator<int>());
+    BOOST_TEST_EQ(h(0), 8);
+    BOOST_TEST_EQ(heap_allocations, 0);
+  }
+
+  // Function pointers, emptiness and swapping
+  {
+    func6 g;
+    BOOST_TEST(g.empty());
+    BOOST_TEST(g == 0);
+    BOOST_TEST(!g);
+
+    g = &twice;
+    BOOST_TEST(g != 0);
+    BOOST_TEST_EQ(g(4), 8);
+
+    func6 h = capture<5>(5);
+    swap(g, h);
+    BOOST_TEST_EQ(g(0), 10);
+    BOOST_TEST_EQ(h(4), 8);
+
+    g.clear();
+    BOOST_TEST(g.empty());
+    BOOST_TEST_THROWS(g(0), boost::bad_function_call);
+
+    // The base classes see the same emptiness
+    boost::function<long(long)> f;
+    const boost::function_base& base = f;
+    BOOST_TEST(base.empty());
+    f = &twice;
+    BOOST_TEST(!base.empty());
+    f = 0;
+    BOOST_TEST(base.empty());
+  }
+
+  // The portable syntax uses the default buffer
+  {
+    heap_allocations = 0;
+    unary<boost::function1>::type g = capture<2>(6);
+    BOOST_TEST_EQ(g(0), 12);
+    BOOST_TEST_EQ(heap_allocations, 0);
+  }
+
+  // Over-aligned function objects are stored inline in a suitably
+  // aligned buffer, and get aligned memory when they go to the heap
+  {
+    typedef boost::basic_function<long(long), 64, 32> aligned;
+    aligned g = wide(1);
+    aligned g2(g);
+    BOOST_TEST_EQ(g2(1), 2);
+    BOOST_TEST(stored_inline(g2, g2.target<wide>()));
+    BOOST_TEST(is_aligned(g2.target<wide>()));
+
+    boost::function<long(long)> f = wide(2);
+    boost::function<long(long)> f2(f);
+    BOOST_TEST_EQ(f2(1), 3);
+    BOOST_TEST(!stored_inline(f2, f2.target<wide>()));
+    BOOST_TEST(is_aligned(f.target<wide>()));
+    BOOST_TEST(is_aligned(f2.target<wide>()));
+  }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  {
+    heap_allocations = 0;
+    func6 g = capture<6>(7);
+    func6 h(static_cast<func6&&>(g));
+    BOOST_TEST(g.empty());
+    BOOST_TEST_EQ(h(0), 14);
+    BOOST_TEST_EQ(heap_allocations, 0);
+  }
+#endif
+
+  return boost::report_errors();
+}
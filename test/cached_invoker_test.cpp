@@ -0,0 +1,125 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#define BOOST_FUNCTION_CACHE_INVOKER
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+static int twice(int x) { return 2 * x; }
+static int three() { return 3; }
+
+static int record = 0;
+static void store(int x) { record = x; }
+
+struct add
+{
+  explicit add(int v): value(v) {}
+  int operator()(int x) const { return value + x; }
+  int value;
+};
+
+// Stored on the heap
+struct add_large
+{
+  explicit add_large(int v) { values[0] = v; }
+  int operator()(int x) const { return values[0] + x; }
+  int values[64];
+};
+
+struct counter
+{
+  counter(): calls(0) {}
+  int operator()(int x) { return x + ++calls; }
+  int calls;
+};
+
+int main()
+{
+  typedef boost::function<int(int)> func;
+
+  BOOST_TEST_EQ(sizeof(func), sizeof(boost::function_base));
+  BOOST_TEST_EQ(sizeof(boost::function_base),
+                2 * sizeof(void*) + sizeof(boost::detail::function::function_buffer));
+
+  // Every way of setting a target keeps the cached invoker in step
+  {
+    func f = &twice;
+    func g = add(1);
+    func h = add_large(2);
+    BOOST_TEST_EQ(f(3), 6);
+    BOOST_TEST_EQ(g(3), 4);
+    BOOST_TEST_EQ(h(3), 5);
+
+    func c(g);
+    BOOST_TEST_EQ(c(1), 2);
+    c = h;
+    BOOST_TEST_EQ(c(1), 3);
+
+    f.swap(g);
+    BOOST_TEST_EQ(f(3), 4);
+    BOOST_TEST_EQ(g(3), 6);
+    swap(f, h);
+    BOOST_TEST_EQ(f(3), 5);
+    BOOST_TEST_EQ(h(3), 4);
+
+    func e;
+    e.swap(g);
+    BOOST_TEST(g.empty());
+    BOOST_TEST_EQ(e(4), 8);
+    BOOST_TEST_THROWS(g(4), boost::bad_function_call);
+
+    g.assign(add(7), std::allocator<int>());
+    BOOST_TEST_EQ(g(0), 7);
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    func m(static_cast<func&&>(g));
+    BOOST_TEST_EQ(m(1), 8);
+    g = static_cast<func&&>(h);
+    BOOST_TEST_EQ(g(1), 2);
+#endif
+
+    e.clear();
+    BOOST_TEST_THROWS(e(0), boost::bad_function_call);
+    e = counter();
+    BOOST_TEST_EQ(e(0), 1);
+    BOOST_TEST_EQ(e(0), 2);
+  }
+
+  // Other signatures and wrappers
+  {
+    boost::function0<int> f = &three;
+    BOOST_TEST_EQ(f(), 3);
+
+    boost::function1<void, int> g = &store;
+    g(5);
+    BOOST_TEST_EQ(record, 5);
+  }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  {
+    boost::unique_function<int(int)> u = add(2);
+    BOOST_TEST_EQ(u(1), 3);
+    boost::unique_function<int(int)> v(static_cast<boost::unique_function<int(int)>&&>(u));
+    BOOST_TEST_EQ(v(1), 3);
+    u = add_large(4);
+    swap(u, v);
+    BOOST_TEST_EQ(u(1), 3);
+    BOOST_TEST_EQ(v(1), 5);
+  }
+#endif
+
+  {
+    boost::inplace_function<int(int), 16> f = add(3);
+    boost::inplace_function<int(int), 16> g = &twice;
+    f.swap(g);
+    BOOST_TEST_EQ(f(2), 4);
+    BOOST_TEST_EQ(g(2), 5);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,100 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+struct base
+{
+  virtual ~base() {}
+  virtual int kind() const { return 1; }
+};
+
+struct counter: base
+{
+  counter(): value(0) {}
+
+  int add(int x) { value += x; return value; }
+  int get() const { return value; }
+  void reset() { value = 0; }
+  int sum(int a, int b, int c) const { return value + a + b + c; }
+  virtual int kind() const { return 2; }
+
+  int value;
+};
+
+int main()
+{
+  counter c;
+
+  // Calls go to the bound object
+  {
+    boost::function<int (int)> f = boost::make_delegate(&c, &counter::add);
+    BOOST_TEST_EQ(f(2), 2);
+    BOOST_TEST_EQ(f(3), 5);
+    BOOST_TEST_EQ(c.value, 5);
+
+    boost::function0<int> g = boost::make_delegate(&c, &counter::get);
+    BOOST_TEST_EQ(g(), 5);
+
+    boost::function<int (int, int, int)> h = boost::make_delegate(&c, &counter::sum);
+    BOOST_TEST_EQ(h(1, 2, 3), 11);
+  }
+
+  // const objects, virtual functions and discarded results
+  {
+    const counter& cc = c;
+    boost::function<int ()> f = boost::make_delegate(&cc, &counter::get);
+    BOOST_TEST_EQ(f(), 5);
+
+    base* b = &c;
+    boost::function<int ()> k = boost::make_delegate(b, &base::kind);
+    BOOST_TEST_EQ(k(), 2);
+
+    boost::function<void (int)> v = boost::make_delegate(&c, &counter::add);
+    v(1);
+    BOOST_TEST_EQ(c.value, 6);
+
+    boost::function<void ()> r = boost::make_delegate(&c, &counter::reset);
+    r();
+    BOOST_TEST_EQ(c.value, 0);
+  }
+
+  // Delegates are stored inline, copied with a memcpy and retrievable
+  {
+    typedef boost::delegate<counter, int (counter::*)(int)> add_delegate;
+
+    boost::function<int (int)> f = boost::make_delegate(&c, &counter::add);
+    boost::function<int (int)> g = f;
+    BOOST_TEST_EQ(g(4), 4);
+    BOOST_TEST(f.target_type() == boost::typeindex::type_id<add_delegate>());
+
+    const add_delegate* d = f.target<add_delegate>();
+    BOOST_TEST(d != 0);
+    BOOST_TEST(d->object() == &c);
+    BOOST_TEST(d->member() == &counter::add);
+    BOOST_TEST(f.target<int (counter::*)(int)>() == 0);
+
+    boost::function<int (int)> e;
+    e.swap(f);
+    BOOST_TEST(f.empty());
+    BOOST_TEST_EQ(e(1), 5);
+
+    boost::inplace_function<int (int), sizeof(add_delegate)> i =
+      boost::make_delegate(&c, &counter::add);
+    BOOST_TEST_EQ(i(1), 6);
+  }
+
+  // A null member pointer gives an empty function
+  {
+    int (counter::*none)(int) = 0;
+    boost::function<int (int)> f = boost::make_delegate(&c, none);
+    BOOST_TEST(f.empty());
+  }
+
+  return boost::report_errors();
+}
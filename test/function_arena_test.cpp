@@ -0,0 +1,160 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/function/function_arena.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/static_assert.hpp>
+#include <cstddef>
+
+static int live = 0;
+
+// Too large for the small-object buffer
+struct large
+{
+  int operator()(int x) const { return x + value; }
+
+  int value;
+  long padding[8];
+};
+
+struct counted
+{
+  explicit counted(int v) : value(v) { ++live; }
+  counted(const counted& other) : value(other.value) { ++live; }
+  ~counted() { --live; }
+
+  int operator()(int x) const { return x * value; }
+
+  int value;
+  long padding[8];
+};
+
+large make_large(int value)
+{
+  large l = { value, { 0 } };
+  return l;
+}
+
+static int negate(int x)
+{
+  return -x;
+}
+
+static bool within(const void* p, const char* buffer, std::size_t size)
+{
+  const char* c = static_cast<const char*>(p);
+  return c >= buffer && c < buffer + size;
+}
+
+typedef boost::detail::function::functor_manager_a<large, boost::function_arena_allocator<char> >
+  large_manager;
+typedef boost::detail::function::functor_manager_a<counted, boost::function_arena_allocator<char> >
+  counted_manager;
+typedef boost::detail::function::functor_manager_a<large, std::allocator<char> >
+  heap_manager;
+
+// Trivially destructible function objects in an arena have nothing to destroy
+BOOST_STATIC_ASSERT((boost::detail::function::vtable_entries<
+                       large_manager, large, boost::detail::function::function_buffer>::trivial_destroy));
+BOOST_STATIC_ASSERT((!boost::detail::function::vtable_entries<
+                       counted_manager, counted, boost::detail::function::function_buffer>::trivial_destroy));
+BOOST_STATIC_ASSERT((!boost::detail::function::vtable_entries<
+                       heap_manager, large, boost::detail::function::function_buffer>::trivial_destroy));
+
+int main()
+{
+  // Bump allocation through the buffer, then through chunks
+  {
+    char buffer[256];
+    boost::function_arena arena(buffer, sizeof(buffer), 1024);
+    void* a = arena.allocate(10, 1);
+    BOOST_TEST_EQ(a, static_cast<void*>(buffer));
+    void* b = arena.allocate(8, 8);
+    BOOST_TEST(within(b, buffer, sizeof(buffer)));
+    BOOST_TEST_EQ(reinterpret_cast<std::size_t>(b) % 8, 0u);
+    BOOST_TEST(static_cast<char*>(b) >= buffer + 10);
+
+    void* c = arena.allocate(300, 8);
+    BOOST_TEST(!within(c, buffer, sizeof(buffer)));
+    void* d = arena.allocate(2000, 64);
+    BOOST_TEST_EQ(reinterpret_cast<std::size_t>(d) % 64, 0u);
+
+    // The chunks are kept for the next round
+    arena.reset();
+    BOOST_TEST_EQ(arena.allocate(10, 1), static_cast<void*>(buffer));
+    BOOST_TEST_EQ(arena.allocate(300, 8), c);
+
+    arena.release();
+    BOOST_TEST_EQ(arena.allocate(10, 1), static_cast<void*>(buffer));
+  }
+
+  // Functions and their copies allocate from the arena
+  {
+    char buffer[1024];
+    boost::function_arena arena(buffer, sizeof(buffer));
+    boost::function<int (int)> f(make_large(1), &arena);
+    BOOST_TEST_EQ(f(2), 3);
+    BOOST_TEST(within(f.target<large>(), buffer, sizeof(buffer)));
+
+    boost::function<int (int)> g(f);
+    BOOST_TEST_EQ(g(3), 4);
+    BOOST_TEST(within(g.target<large>(), buffer, sizeof(buffer)));
+    BOOST_TEST(g.target<large>() != f.target<large>());
+
+    boost::function<int (int)> h;
+    h.assign(make_large(5), boost::function_arena_allocator<int>(&arena));
+    BOOST_TEST_EQ(h(1), 6);
+    BOOST_TEST(within(h.target<large>(), buffer, sizeof(buffer)));
+
+    boost::function1<int, int> n(make_large(2), &arena);
+    BOOST_TEST_EQ(n(2), 4);
+
+    f.clear();
+    g.clear();
+    h.clear();
+    n.clear();
+    arena.reset();
+  }
+
+  // Destroying the functions runs the destructor of their function
+  // objects only
+  {
+    boost::function_arena arena;
+    {
+      boost::function<int (int)> f(counted(3), &arena);
+      boost::function<int (int)> g(f);
+      BOOST_TEST_EQ(live, 2);
+      BOOST_TEST_EQ(g(2), 6);
+      f.clear();
+      BOOST_TEST_EQ(live, 1);
+    }
+    BOOST_TEST_EQ(live, 0);
+  }
+
+  // Small function objects do not use the arena
+  {
+    char buffer[64];
+    boost::function_arena arena(buffer, sizeof(buffer));
+    boost::function<int (int)> f(&negate, &arena);
+    BOOST_TEST_EQ(f(2), -2);
+    BOOST_TEST_EQ(arena.allocate(1, 1), static_cast<void*>(buffer));
+  }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  {
+    char buffer[1024];
+    boost::function_arena arena(buffer, sizeof(buffer));
+    boost::unique_function<int (int)> f(make_large(4), &arena);
+    boost::unique_function<int (int)> g(std::move(f));
+    BOOST_TEST_EQ(g(1), 5);
+    BOOST_TEST(within(g.target<large>(), buffer, sizeof(buffer)));
+  }
+#endif
+
+  return boost::report_errors();
+}
@@ -0,0 +1,139 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function/function_executor.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_HDR_CONDITION_VARIABLE) && \
+    !defined(BOOST_NO_CXX11_HDR_MUTEX) && \
+    !defined(BOOST_NO_CXX11_HDR_THREAD) && \
+    !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <atomic>
+
+static std::atomic<long> total(0);
+
+struct add
+{
+  void operator()() const { total += value; }
+  long value;
+};
+
+// Too large for the tasks of the executor
+struct add_large
+{
+  void operator()() const { total += values[0]; }
+  long values[32];
+};
+
+// Submits two halves of a range until they are small, from the workers
+struct sum_range
+{
+  void operator()() const
+  {
+    if (end - begin <= 4) {
+      for (long i = begin; i < end; ++i)
+        total += i;
+    } else {
+      long middle = begin + (end - begin) / 2;
+      sum_range low = { executor, begin, middle };
+      sum_range high = { executor, middle, end };
+      executor->submit(low);
+      executor->submit(high);
+    }
+  }
+
+  boost::function_executor* executor;
+  long begin;
+  long end;
+};
+
+int main()
+{
+  // Tasks from outside the workers
+  for (std::size_t threads = 1; threads <= 4; threads *= 2) {
+    total = 0;
+    boost::function_executor executor(threads);
+    BOOST_TEST_EQ(executor.size(), threads);
+    for (long i = 1; i <= 1000; ++i) {
+      add a = { i };
+      executor.submit(a);
+    }
+    executor.wait();
+    BOOST_TEST_EQ(total.load(), 500500);
+  }
+
+  // Tasks submitted by tasks, including more than a deque holds
+  for (std::size_t threads = 1; threads <= 4; threads *= 2) {
+    total = 0;
+    {
+      boost::function_executor executor(threads);
+      sum_range r = { &executor, 0, 100000 };
+      executor.submit(r);
+    }
+    BOOST_TEST_EQ(total.load(), 100000L * 99999 / 2);
+  }
+
+  // Large function objects, boost::function and empty tasks
+  {
+    total = 0;
+    boost::function_executor executor(2);
+    add_large large = { { 5 } };
+    executor.submit(large);
+
+    add a = { 7 };
+    boost::function<void()> f = a;
+    executor.submit(f);
+    executor.submit(boost::function<void()>());
+
+    executor.wait();
+    BOOST_TEST_EQ(total.load(), 12);
+  }
+
+  // The deque on its own
+  {
+    typedef boost::inplace_function<void(), 16> task;
+    boost::detail::function::task_deque<task, 4> deque;
+    task t;
+    BOOST_TEST(!deque.pop(t));
+    BOOST_TEST(!deque.steal(t));
+
+    total = 0;
+    for (long i = 1; i <= 4; ++i) {
+      add a = { i };
+      task u(a);
+      BOOST_TEST(deque.push(u));
+    }
+    add a = { 5 };
+    task u(a);
+    BOOST_TEST(!deque.push(u));
+
+    BOOST_TEST(deque.pop(t));
+    t();
+    BOOST_TEST_EQ(total.load(), 4);
+    BOOST_TEST(deque.steal(t));
+    t();
+    BOOST_TEST_EQ(total.load(), 5);
+    BOOST_TEST(deque.push(u));
+    BOOST_TEST(deque.pop(t));
+    t();
+    BOOST_TEST_EQ(total.load(), 10);
+  }
+
+  return boost::report_errors();
+}
+
+#else
+
+int main()
+{
+  return 0;
+}
+
+#endif
@@ -0,0 +1,195 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/ref.hpp>
+#include <memory>
+#ifndef BOOST_NO_CXX11_HDR_UNORDERED_SET
+#include <unordered_set>
+#endif
+
+static int twice(int x) { return 2 * x; }
+static int thrice(int x) { return 3 * x; }
+
+namespace callbacks {
+
+struct add
+{
+  explicit add(int v): value(v) {}
+  int operator()(int x) const { return value + x; }
+  int value;
+};
+
+bool function_equal(const add& x, const add& y) { return x.value == y.value; }
+std::size_t hash_value(const add& x) { return static_cast<std::size_t>(x.value); }
+
+// Stored on the heap
+struct add_large
+{
+  explicit add_large(int v) { values[0] = v; }
+  int operator()(int x) const { return values[0] + x; }
+  int values[64];
+};
+
+bool function_equal(const add_large& x, const add_large& y) { return x.values[0] == y.values[0]; }
+std::size_t hash_value(const add_large& x) { return static_cast<std::size_t>(x.values[0]); }
+
+// Not hashable
+struct subtract
+{
+  int operator()(int x) const { return -x; }
+};
+
+struct counter
+{
+  counter(): value(0) {}
+  int increment(int x) { return value += x; }
+  int decrement(int x) { return value -= x; }
+  int value;
+};
+
+}
+
+namespace boost {
+  template<> struct is_hashable_target<callbacks::add> : true_type {};
+  template<> struct is_hashable_target<callbacks::add_large> : true_type {};
+}
+
+using namespace callbacks;
+
+typedef boost::function<int (int)> func;
+
+static bool equal(const func& f, const func& g)
+{
+  return boost::function_identity_equal()(f, g);
+}
+
+static std::size_t hash(const func& f)
+{
+  return boost::function_hash()(f);
+}
+
+static void check_equal(const func& f, const func& g)
+{
+  BOOST_TEST(equal(f, g));
+  BOOST_TEST(equal(g, f));
+  BOOST_TEST_EQ(hash(f), hash(g));
+}
+
+int main()
+{
+  // Function pointers
+  {
+    func f = &twice;
+    check_equal(f, f);
+    check_equal(f, func(&twice));
+    BOOST_TEST(!equal(f, func(&thrice)));
+  }
+
+  // Function objects with is_hashable_target, inline and on the heap
+  {
+    func f = add(1);
+    check_equal(f, f);
+    check_equal(f, func(add(1)));
+    BOOST_TEST(!equal(f, func(add(2))));
+
+    func g = add_large(1);
+    check_equal(g, func(add_large(1)));
+    BOOST_TEST(!equal(g, func(add_large(2))));
+    BOOST_TEST(!equal(f, g));
+
+    func a;
+    a.assign(add(1), std::allocator<int>());
+    func b;
+    b.assign(add(1), std::allocator<int>());
+    check_equal(a, b);
+  }
+
+  // References compare the referenced object
+  {
+    add a(3), b(3);
+    check_equal(func(boost::ref(a)), func(boost::ref(a)));
+    BOOST_TEST(!equal(func(boost::ref(a)), func(boost::ref(b))));
+    BOOST_TEST(!equal(func(boost::ref(a)), func(boost::cref(a))));
+    BOOST_TEST(!equal(func(boost::ref(a)), func(a)));
+  }
+
+  // Member pointers and delegates
+  {
+    boost::function<int (counter*, int)> f = &counter::increment;
+    boost::function<int (counter*, int)> g = &counter::increment;
+    boost::function<int (counter*, int)> h = &counter::decrement;
+    BOOST_TEST(boost::function_identity_equal()(f, g));
+    BOOST_TEST_EQ(boost::function_hash()(f), boost::function_hash()(g));
+    BOOST_TEST(!boost::function_identity_equal()(f, h));
+
+    counter c, d;
+    func i = boost::make_delegate(&c, &counter::increment);
+    check_equal(i, func(boost::make_delegate(&c, &counter::increment)));
+    BOOST_TEST(!equal(i, func(boost::make_delegate(&d, &counter::increment))));
+    BOOST_TEST(!equal(i, func(boost::make_delegate(&c, &counter::decrement))));
+  }
+
+  // Empty functions are equal, other targets are only equal to themselves
+  {
+    func e;
+    check_equal(e, func());
+    BOOST_TEST(!equal(e, func(&twice)));
+    BOOST_TEST(!equal(func(&twice), e));
+
+    func s = subtract();
+    check_equal(s, s);
+    BOOST_TEST(!equal(s, func(s)));
+    BOOST_TEST(!equal(s, e));
+    BOOST_TEST(!equal(e, s));
+    BOOST_TEST_EQ(hash(s), hash(func(subtract())));
+  }
+
+  // Other wrappers
+  {
+    boost::inplace_function<int (int), 16> f = add(4);
+    boost::inplace_function<int (int), 16> g = add(4);
+    BOOST_TEST(boost::function_identity_equal()(f, g));
+    BOOST_TEST_EQ(boost::function_hash()(f), boost::function_hash()(g));
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    boost::unique_function<int (int)> u = add_large(5);
+    boost::unique_function<int (int)> v = add_large(5);
+    BOOST_TEST(boost::function_identity_equal()(u, v));
+    BOOST_TEST_EQ(boost::function_hash()(u), boost::function_hash()(v));
+#endif
+  }
+
+#ifndef BOOST_NO_CXX11_HDR_UNORDERED_SET
+  // Deduplicating subscriptions
+  {
+    counter c;
+    std::unordered_set<func, boost::function_hash, boost::function_identity_equal> set;
+    BOOST_TEST(set.insert(&twice).second);
+    BOOST_TEST(!set.insert(&twice).second);
+    BOOST_TEST(set.insert(add(1)).second);
+    BOOST_TEST(!set.insert(add(1)).second);
+    BOOST_TEST(set.insert(boost::make_delegate(&c, &counter::increment)).second);
+    BOOST_TEST(!set.insert(boost::make_delegate(&c, &counter::increment)).second);
+    BOOST_TEST_EQ(set.size(), 3u);
+    BOOST_TEST_EQ(set.count(func(add(1))), 1u);
+    BOOST_TEST_EQ(set.count(func(add(2))), 0u);
+
+    // Unhashable targets are kept apart, and each element finds itself
+    BOOST_TEST(set.insert(subtract()).second);
+    BOOST_TEST(set.insert(subtract()).second);
+    BOOST_TEST_EQ(set.size(), 5u);
+    for (std::unordered_set<func, boost::function_hash,
+                            boost::function_identity_equal>::const_iterator i = set.begin();
+         i != set.end(); ++i)
+      BOOST_TEST(set.find(*i) == i);
+  }
+#endif
+
+  return boost::report_errors();
+}
@@ -0,0 +1,162 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function/function_list.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_HDR_MUTEX) && \
+    !defined(BOOST_NO_CXX11_HDR_THREAD) && \
+    !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) && \
+    !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static std::atomic<int> live(0);
+
+struct record
+{
+  record(std::vector<int>* o, int v): out(o), value(v), alive(true) { ++live; }
+  record(const record& other): out(other.out), value(other.value), alive(true) { ++live; }
+  ~record() { alive = false; --live; }
+
+  void operator()(int x) const
+  {
+    BOOST_TEST(alive);
+    if (out)
+      out->push_back(value + x);
+  }
+
+  std::vector<int>* out;
+  int value;
+  volatile bool alive;
+};
+
+struct counter
+{
+  explicit counter(std::atomic<long>* c): calls(c) {}
+  void operator()(int) const { ++*calls; }
+  std::atomic<long>* calls;
+};
+
+struct count_functions
+{
+  explicit count_functions(int* c): count(c) {}
+  void operator()(const boost::function<void (int)>& f) const { if (f) ++*count; }
+  int* count;
+};
+
+int main()
+{
+  typedef boost::function_list<void (int)> list;
+
+  // Calls in connection order
+  {
+    std::vector<int> out;
+    list l;
+    BOOST_TEST(l.empty());
+    l(1);
+
+    list::connection a = l.connect(record(&out, 10));
+    list::connection b = l.connect(record(&out, 20));
+    list::connection c = l.connect(record(&out, 30));
+    BOOST_TEST(a != 0 && b != 0 && c != 0);
+    BOOST_TEST(a != b && b != c);
+    BOOST_TEST_EQ(l.size(), 3u);
+    BOOST_TEST_EQ(l.connect(boost::function<void (int)>()), 0u);
+
+    l(1);
+    BOOST_TEST_EQ(out.size(), 3u);
+    BOOST_TEST_EQ(out[0], 11);
+    BOOST_TEST_EQ(out[1], 21);
+    BOOST_TEST_EQ(out[2], 31);
+
+    BOOST_TEST(l.disconnect(b));
+    BOOST_TEST(!l.disconnect(b));
+    out.clear();
+    l(2);
+    BOOST_TEST_EQ(out.size(), 2u);
+    BOOST_TEST_EQ(out[0], 12);
+    BOOST_TEST_EQ(out[1], 32);
+
+    int count = 0;
+    l.for_each(count_functions(&count));
+    BOOST_TEST_EQ(count, 2);
+
+    BOOST_TEST(l.disconnect(a));
+    BOOST_TEST(l.disconnect(c));
+    BOOST_TEST(l.empty());
+    BOOST_TEST_EQ(l.size(), 0u);
+
+    l.connect(record(&out, 0));
+    l.clear();
+    BOOST_TEST(l.empty());
+  }
+
+  // Retired snapshots are destroyed once no call can see them
+  {
+    list l;
+    for (int i = 0; i < 10; ++i)
+      l.connect(record(0, i));
+    BOOST_TEST(live.load() <= 10 + 9 + 8);
+  }
+  {
+    list l;
+    for (int i = 0; i < 3; ++i)
+      l.connect(record(0, i));
+  }
+  BOOST_TEST(live.load() <= 2);
+
+  // Calls while other threads connect and disconnect
+  {
+    list l;
+    std::atomic<long> calls(0);
+    std::atomic<bool> done(false);
+    l.connect(counter(&calls));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; ++t) {
+      threads.push_back(std::thread([&] {
+        while (!done.load())
+          l(0);
+      }));
+    }
+    for (int t = 0; t < 2; ++t) {
+      threads.push_back(std::thread([&] {
+        for (int i = 0; i < 500; ++i) {
+          list::connection c = l.connect(record(0, i));
+          BOOST_TEST(l.disconnect(c));
+        }
+      }));
+    }
+
+    for (std::size_t t = 2; t < threads.size(); ++t)
+      threads[t].join();
+    done = true;
+    threads[0].join();
+    threads[1].join();
+
+    BOOST_TEST_EQ(l.size(), 1u);
+    long before = calls.load();
+    l(0);
+    BOOST_TEST_EQ(calls.load(), before + 1);
+  }
+
+  return boost::report_errors();
+}
+
+#else
+
+int main()
+{
+  return 0;
+}
+
+#endif
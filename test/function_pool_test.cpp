@@ -0,0 +1,131 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/function/function_pool_allocator.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_HDR_THREAD) && \
+    !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+typedef boost::detail::function::size_class_pool pool;
+
+static int live = 0;
+
+// Too large for the small-object buffer
+struct large
+{
+  large(int v) : value(v), padding() { ++live; }
+  large(const large& other) : value(other.value), padding() { ++live; }
+  ~large() { --live; }
+
+  int operator()(int x) const { return x + value + padding[0]; }
+
+  int value;
+  long padding[8];
+};
+
+int main()
+{
+  // Blocks of the same size class are reused by the thread freeing them
+  {
+    void* p = pool::allocate(40);
+    pool::deallocate(p, 40);
+    void* q = pool::allocate(33);
+    BOOST_TEST_EQ(p, q);
+    void* r = pool::allocate(48);
+    BOOST_TEST_NE(q, r);
+    pool::deallocate(q, 33);
+    pool::deallocate(r, 48);
+
+    void* big = pool::allocate(1000);
+    pool::deallocate(big, 1000);
+  }
+
+  // Blocks freed by other threads return to the thread that allocated them
+  {
+    const int n = 8;
+    std::vector<void*> blocks;
+    for (int i = 0; i < n; ++i)
+      blocks.push_back(pool::allocate(200));
+
+    std::thread t([&] {
+      for (int i = 0; i < n; ++i)
+        pool::deallocate(blocks[i], 200);
+    });
+    t.join();
+
+    std::vector<void*> again;
+    for (int i = 0; i < n; ++i)
+      again.push_back(pool::allocate(200));
+    std::sort(blocks.begin(), blocks.end());
+    std::sort(again.begin(), again.end());
+    BOOST_TEST(blocks == again);
+    for (int i = 0; i < n; ++i)
+      pool::deallocate(again[i], 200);
+  }
+
+  // Functions pooled through the allocator
+  {
+    boost::function<int (int)> f(large(1), boost::function_pool_allocator<int>());
+    BOOST_TEST_EQ(f(2), 3);
+    boost::function<int (int)> g(f);
+    BOOST_TEST_EQ(g(3), 4);
+    f.clear();
+    BOOST_TEST_EQ(live, 1);
+
+    std::thread t([&] {
+      boost::function<int (int)> h(g);
+      g.clear();
+      BOOST_TEST_EQ(h(4), 5);
+    });
+    t.join();
+  }
+  BOOST_TEST_EQ(live, 0);
+
+  // Functions created and destroyed by different threads, also as the
+  // threads exit; pooled as a whole under BOOST_FUNCTION_POOLED_ALLOCATION
+  {
+    std::vector<boost::function<int (int)> > functions(100);
+    for (int round = 0; round < 10; ++round) {
+      std::thread producer([&] {
+        for (int i = 0; i < 100; ++i)
+          functions[i] = large(i);
+      });
+      producer.join();
+
+      int sum = 0;
+      for (int i = 0; i < 100; ++i)
+        sum += functions[i](0);
+      BOOST_TEST_EQ(sum, 4950);
+
+      std::thread consumer([&] {
+        for (int i = 0; i < 50; ++i)
+          functions[i].clear();
+      });
+      consumer.join();
+    }
+    functions.clear();
+    BOOST_TEST_EQ(live, 0);
+  }
+
+  return boost::report_errors();
+}
+
+#else
+
+int main()
+{
+  return 0;
+}
+
+#endif
@@ -0,0 +1,130 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/ref.hpp>
+
+static int twice(int x) { return 2 * x; }
+
+struct counter
+{
+  counter(): calls(0) {}
+
+  int operator()(int x) { ++calls; return x + calls; }
+
+  int calls;
+};
+
+struct constant
+{
+  int operator()(int) const { return 7; }
+};
+
+static int record = 0;
+
+static void store(int x) { record = x; }
+
+struct point
+{
+  int scaled(int factor) const { return x * factor; }
+
+  int x;
+};
+
+// The calls are made through a function_ref parameter, as in callbacks
+// that are only invoked before returning
+static int call(boost::function_ref<int(int)> f, int x)
+{
+  return f(x);
+}
+
+static int call_portable(boost::function_ref1<int, int> f, int x)
+{
+  return f(x);
+}
+
+int main()
+{
+  // An object pointer and an invoker
+  BOOST_TEST_EQ(sizeof(boost::function_ref<int(int)>), 2 * sizeof(void*));
+
+  // Functions and function pointers
+  BOOST_TEST_EQ(call(twice, 3), 6);
+  BOOST_TEST_EQ(call(&twice, 4), 8);
+  BOOST_TEST_EQ(call_portable(&twice, 5), 10);
+
+  // Function objects are referenced, not copied
+  {
+    counter c;
+    BOOST_TEST_EQ(call(c, 1), 2);
+    BOOST_TEST_EQ(call(c, 1), 3);
+    BOOST_TEST_EQ(c.calls, 2);
+
+    BOOST_TEST_EQ(call(boost::ref(c), 1), 4);
+    BOOST_TEST_EQ(c.calls, 3);
+
+    const constant k = constant();
+    BOOST_TEST_EQ(call(k, 0), 7);
+    BOOST_TEST_EQ(call(constant(), 0), 7);
+    BOOST_TEST_EQ(call(boost::cref(k), 0), 7);
+  }
+
+  // An existing boost::function is referenced as well
+  {
+    boost::function<int(int)> f = counter();
+    BOOST_TEST_EQ(call(f, 1), 2);
+    BOOST_TEST_EQ(call(f, 1), 3);
+
+    boost::function<int(int)> empty;
+    BOOST_TEST_THROWS(call(empty, 1), boost::bad_function_call);
+  }
+
+  // Copies refer to the same callable
+  {
+    counter c;
+    boost::function_ref<int(int)> r1(c);
+    boost::function_ref<int(int)> r2(r1);
+    r1(0);
+    r2(0);
+    BOOST_TEST_EQ(c.calls, 2);
+  }
+
+  // void results and conversions of the result
+  {
+    boost::function_ref<void(int)> r(&store);
+    r(5);
+    BOOST_TEST_EQ(record, 5);
+
+    boost::function_ref<void(int)> r2(&twice);
+    r2(1);
+
+    boost::function_ref<long(int)> r3(&twice);
+    BOOST_TEST_EQ(r3(6), 12L);
+  }
+
+  // Member function and data member pointers are referenced like
+  // function objects
+  {
+    point p = { 3 };
+    int (point::*scaled)(int) const = &point::scaled;
+    boost::function_ref<int(const point*, int)> r(scaled);
+    BOOST_TEST_EQ(r(&p, 2), 6);
+
+    int point::*x = &point::x;
+    boost::function_ref<int(point&)> r2(x);
+    BOOST_TEST_EQ(r2(p), 3);
+
+    boost::function_ref2<int, const point&, int> r3(scaled);
+    boost::function_ref2<int, const point&, int> r4(r3);
+    BOOST_TEST_EQ(r4(p, 4), 12);
+
+    BOOST_TEST_EQ(boost::function_ref<int(const point&, int)>(&point::scaled)(p, 5), 15);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,173 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function/function_ring.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+#if !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+    !defined(BOOST_NO_CXX11_HDR_THREAD) && \
+    !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) && \
+    !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+static std::atomic<int> live(0);
+
+struct record
+{
+  record(std::vector<int>* o, int v): out(o), value(v) { ++live; }
+  record(const record& other) BOOST_NOEXCEPT : out(other.out), value(other.value) { ++live; }
+  ~record() { --live; }
+
+  int operator()(int x) const
+  {
+    if (out)
+      out->push_back(value + x);
+    return value + x;
+  }
+
+  std::vector<int>* out;
+  int value;
+};
+
+struct throw_on_copy
+{
+  throw_on_copy() {}
+  throw_on_copy(const throw_on_copy&) { throw std::runtime_error("copy"); }
+  throw_on_copy(throw_on_copy&&) BOOST_NOEXCEPT {}
+
+  int operator()(int) const { return 0; }
+};
+
+struct throw_on_call
+{
+  int operator()(int) const { throw std::runtime_error("call"); }
+};
+
+struct add
+{
+  void operator()() const { *sum += value; }
+  std::atomic<long>* sum;
+  long value;
+};
+
+int main()
+{
+  typedef boost::function_ring<int (int), 4, 32> ring;
+
+  // First in, first out, up to the capacity
+  {
+    std::vector<int> out;
+    ring r;
+    BOOST_TEST(r.empty());
+    BOOST_TEST_EQ(r.capacity(), 4u);
+    BOOST_TEST(!r.try_call(0));
+
+    for (int i = 0; i < 4; ++i)
+      BOOST_TEST(r.try_push(record(&out, i * 10)));
+    BOOST_TEST(!r.try_push(record(&out, 40)));
+    BOOST_TEST_EQ(r.size(), 4u);
+
+    BOOST_TEST(r.try_call(1));
+    BOOST_TEST(r.try_call(2));
+    BOOST_TEST_EQ(out.size(), 2u);
+    BOOST_TEST_EQ(out[0], 1);
+    BOOST_TEST_EQ(out[1], 12);
+
+    // Around the end of the slots
+    BOOST_TEST(r.try_push(record(&out, 40)));
+    BOOST_TEST(r.try_push(record(&out, 50)));
+    ring::function_type f;
+    BOOST_TEST(r.try_pop(f));
+    BOOST_TEST_EQ(f(3), 23);
+    while (r.try_call(4)) {}
+    BOOST_TEST_EQ(out.size(), 6u);
+    BOOST_TEST_EQ(out[3], 34);
+    BOOST_TEST_EQ(out[4], 44);
+    BOOST_TEST_EQ(out[5], 54);
+    BOOST_TEST(r.empty());
+  }
+  BOOST_TEST_EQ(live.load(), 0);
+
+  // Functions left in the ring are destroyed with it
+  {
+    ring r;
+    r.try_push(record(0, 1));
+    r.try_push(record(0, 2));
+    BOOST_TEST_EQ(live.load(), 2);
+  }
+  BOOST_TEST_EQ(live.load(), 0);
+
+  // Empty functions and functions that fail to be constructed are skipped
+  {
+    std::vector<int> out;
+    ring r;
+    BOOST_TEST(r.try_push(boost::function<int (int)>()));
+    throw_on_copy t;
+    BOOST_TEST_THROWS(r.try_push(t), std::runtime_error);
+    BOOST_TEST(r.try_push(record(&out, 7)));
+    BOOST_TEST(r.try_call(0));
+    BOOST_TEST_EQ(out.size(), 1u);
+    BOOST_TEST(r.empty());
+  }
+
+  // A slot is freed when its function throws
+  {
+    ring r;
+    for (int i = 0; i < 4; ++i)
+      r.try_push(throw_on_call());
+    BOOST_TEST_THROWS(r.try_call(0), std::runtime_error);
+    BOOST_TEST(r.try_push(throw_on_call()));
+    BOOST_TEST(!r.try_push(throw_on_call()));
+  }
+
+  // Several producers and consumers
+  {
+    static boost::function_ring<void (), 64> r;
+    std::atomic<long> sum(0);
+    std::atomic<int> producing(2);
+    const long per_producer = 20000;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 2; ++p) {
+      threads.push_back(std::thread([&] {
+        for (long i = 1; i <= per_producer; ++i) {
+          add a = { &sum, i };
+          while (!r.try_push(a))
+            std::this_thread::yield();
+        }
+        --producing;
+      }));
+    }
+    for (int c = 0; c < 2; ++c) {
+      threads.push_back(std::thread([&] {
+        while (producing.load() != 0 || !r.empty()) {
+          if (!r.try_call())
+            std::this_thread::yield();
+        }
+      }));
+    }
+    for (std::size_t t = 0; t < threads.size(); ++t)
+      threads[t].join();
+
+    BOOST_TEST_EQ(sum.load(), 2 * per_producer * (per_producer + 1) / 2);
+  }
+
+  return boost::report_errors();
+}
+
+#else
+
+int main()
+{
+  return 0;
+}
+
+#endif
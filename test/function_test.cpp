@@ -678,6 +678,29 @@ static void test_exception()
   catch(boost::bad_function_call const&) {
     // okay
   }
+
+  // Every empty state calls through the same throwing vtable
+  boost::function<int& (int)> r;
+  BOOST_TEST_THROWS(r(1), boost::bad_function_call);
+
+  boost::function<void ()> v = &write_five;
+  v.clear();
+  BOOST_CHECK(v.empty());
+  BOOST_TEST_THROWS(v(), boost::bad_function_call);
+
+  boost::function<void ()> c(v);
+  BOOST_CHECK(!c);
+  BOOST_TEST_THROWS(c(), boost::bad_function_call);
+
+  v = &write_five;
+  v = 0;
+  BOOST_TEST_THROWS(v(), boost::bad_function_call);
+
+  const boost::function_base& b = f;
+  BOOST_CHECK(b.empty());
+  BOOST_CHECK(b.target_type() == boost::typeindex::type_id<void>());
+  BOOST_CHECK(b.target<int (*)(int, int)>() == 0);
+  BOOST_CHECK(!b.contains(&write_five));
 }
 
 typedef boost::function< void * (void * reader) > reader_type;
@@ -0,0 +1,247 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function/function_timer_wheel.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+typedef boost::function_timer_wheel wheel_type;
+typedef wheel_type::tick_type tick_type;
+
+// Records the tick at which it is called
+struct record
+{
+  void operator()() const { out->push_back(std::make_pair(wheel->now(), id)); }
+
+  std::vector<std::pair<tick_type, int> >* out;
+  wheel_type* wheel;
+  int id;
+};
+
+struct cancel_timer
+{
+  void operator()() const { *result = wheel->cancel(*t); }
+
+  wheel_type* wheel;
+  wheel_type::timer* t;
+  bool* result;
+};
+
+struct reschedule
+{
+  void operator()() const
+  {
+    ++*count;
+    if (*count < 3)
+      wheel->schedule_after(10, *this);
+  }
+
+  wheel_type* wheel;
+  int* count;
+};
+
+struct thrower
+{
+  void operator()() const { throw std::runtime_error("timer"); }
+};
+
+static unsigned long long random_state = 12345;
+
+static unsigned long long random_number()
+{
+  random_state = random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return random_state >> 33;
+}
+
+int main()
+{
+  std::vector<std::pair<tick_type, int> > out;
+
+  // Timers expire at their tick, in order
+  {
+    out.clear();
+    wheel_type w;
+    BOOST_TEST(w.empty());
+    record r5 = { &out, &w, 5 };
+    record r1 = { &out, &w, 1 };
+    record r100 = { &out, &w, 100 };
+    record r5000 = { &out, &w, 5000 };
+    w.schedule_at(5, r5);
+    w.schedule_at(1, r1);
+    w.schedule_after(100, r100);
+    w.schedule_at(5000, r5000);
+    BOOST_TEST_EQ(w.size(), 4u);
+
+    BOOST_TEST_EQ(w.advance_to(4), 1u);
+    BOOST_TEST_EQ(w.now(), 4u);
+    BOOST_TEST_EQ(w.advance_to(10000), 3u);
+    BOOST_TEST_EQ(w.now(), 10000u);
+    BOOST_TEST(w.empty());
+
+    BOOST_TEST_EQ(out.size(), 4u);
+    BOOST_TEST(out[0] == std::make_pair(tick_type(1), 1));
+    BOOST_TEST(out[1] == std::make_pair(tick_type(5), 5));
+    BOOST_TEST(out[2] == std::make_pair(tick_type(100), 100));
+    BOOST_TEST(out[3] == std::make_pair(tick_type(5000), 5000));
+
+    // In the past: at the next tick
+    out.clear();
+    record r0 = { &out, &w, 0 };
+    w.schedule_at(3, r0);
+    BOOST_TEST_EQ(w.advance_to(10000), 0u);
+    BOOST_TEST_EQ(w.advance(1), 1u);
+    BOOST_TEST(out[0] == std::make_pair(tick_type(10001), 0));
+  }
+
+  // Cancellation, and stale timers once their node is reused
+  {
+    out.clear();
+    wheel_type w(1000);
+    record a = { &out, &w, 1 };
+    record b = { &out, &w, 2 };
+    wheel_type::timer ta = w.schedule_after(50, a);
+    wheel_type::timer tb = w.schedule_after(50, b);
+    BOOST_TEST(w.pending(ta));
+    BOOST_TEST(w.cancel(ta));
+    BOOST_TEST(!w.pending(ta));
+    BOOST_TEST(!w.cancel(ta));
+    BOOST_TEST(!w.cancel(wheel_type::timer()));
+
+    wheel_type::timer tc = w.schedule_after(70, a);
+    BOOST_TEST(!w.cancel(ta));
+    BOOST_TEST(w.pending(tc));
+
+    w.advance(100);
+    BOOST_TEST_EQ(out.size(), 2u);
+    BOOST_TEST(out[0] == std::make_pair(tick_type(1050), 2));
+    BOOST_TEST(out[1] == std::make_pair(tick_type(1070), 1));
+    BOOST_TEST(!w.pending(tb));
+    BOOST_TEST(!w.cancel(tc));
+  }
+
+  // Callbacks that cancel and schedule timers
+  {
+    out.clear();
+    wheel_type w;
+    record later = { &out, &w, 1 };
+    wheel_type::timer t = w.schedule_at(20, later);
+    bool cancelled = false;
+    cancel_timer c = { &w, &t, &cancelled };
+    wheel_type::timer self = w.schedule_at(10, c);
+    cancel_timer c2 = { &w, &self, &cancelled };
+    w.advance_to(10);
+    BOOST_TEST(cancelled);
+    BOOST_TEST_EQ(w.size(), 0u);
+
+    // A timer is no longer pending while its callback runs
+    cancelled = true;
+    self = w.schedule_after(5, c2);
+    c2.t = &self;
+    w.advance(5);
+    BOOST_TEST(!cancelled);
+
+    int count = 0;
+    reschedule r = { &w, &count };
+    w.schedule_after(10, r);
+    BOOST_TEST_EQ(w.advance(100), 3u);
+    BOOST_TEST_EQ(count, 3);
+    BOOST_TEST(out.empty());
+  }
+
+  // Empty callbacks and callbacks that throw
+  {
+    out.clear();
+    wheel_type w;
+    w.schedule_at(5, boost::function<void()>());
+    w.schedule_at(5, thrower());
+    record r = { &out, &w, 1 };
+    w.schedule_at(5, r);
+    BOOST_TEST_THROWS(w.advance_to(10), std::runtime_error);
+    BOOST_TEST_EQ(w.now(), 5u);
+    BOOST_TEST_EQ(w.size(), 1u);
+    BOOST_TEST_EQ(w.advance_to(5), 1u);
+    BOOST_TEST_EQ(out.size(), 1u);
+    BOOST_TEST(w.empty());
+  }
+
+  // Timers beyond the span of the wheel
+  {
+    out.clear();
+    wheel_type w(7);
+    tick_type far = (tick_type(1) << 40) + 3;
+    record r = { &out, &w, 1 };
+    w.schedule_at(far, r);
+    w.advance_to(far - 1);
+    BOOST_TEST(out.empty());
+    w.advance_to(far + 1);
+    BOOST_TEST_EQ(out.size(), 1u);
+    BOOST_TEST(out[0] == std::make_pair(far, 1));
+  }
+
+  // Against a multimap, with random schedules, cancels and advances
+  {
+    out.clear();
+    wheel_type w(123456);
+    w.reserve(1000);
+    std::multimap<tick_type, int> expected;
+    std::vector<std::pair<wheel_type::timer, std::multimap<tick_type, int>::iterator> > timers;
+    std::vector<std::pair<tick_type, int> > expired;
+
+    for (int round = 0; round < 2000; ++round) {
+      unsigned long long action = random_number() % 10;
+      if (action < 6) {
+        tick_type delay = random_number() % (action < 3 ? 100 : action < 5 ? 100000 : 100000000);
+        tick_type when = w.now() + delay + 1;
+        record r = { &out, &w, round };
+        timers.push_back(std::make_pair(w.schedule_at(when, r),
+                                        expected.insert(std::make_pair(when, round))));
+      } else if (action < 8 && !timers.empty()) {
+        std::size_t i = random_number() % timers.size();
+        if (w.cancel(timers[i].first))
+          expected.erase(timers[i].second);
+        timers.erase(timers.begin() + i);
+      } else {
+        tick_type to = w.now() + random_number() % 50000;
+        while (!expected.empty() && expected.begin()->first <= to) {
+          expired.push_back(*expected.begin());
+          for (std::size_t i = 0; i < timers.size(); ++i) {
+            if (timers[i].second == expected.begin()) {
+              timers.erase(timers.begin() + i);
+              break;
+            }
+          }
+          expected.erase(expected.begin());
+        }
+        w.advance_to(to);
+      }
+      BOOST_TEST_EQ(w.size(), expected.size());
+    }
+    w.advance_to(w.now() + 200000000);
+    for (std::multimap<tick_type, int>::iterator i = expected.begin(); i != expected.end(); ++i)
+      expired.push_back(*i);
+
+    BOOST_TEST_EQ(out.size(), expired.size());
+    if (out.size() == expired.size()) {
+      for (std::size_t i = 0; i < out.size(); ++i) {
+        // Timers of the same tick expire in any order
+        BOOST_TEST_EQ(out[i].first, expired[i].first);
+      }
+    }
+    std::multimap<tick_type, int> a, b;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+      a.insert(out[i]);
+      b.insert(expired[i < expired.size() ? i : 0]);
+    }
+    BOOST_TEST(a == b);
+  }
+
+  return boost::report_errors();
+}
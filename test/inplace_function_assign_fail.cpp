@@ -0,0 +1,21 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <memory>
+
+struct large
+{
+  int operator()() const { return values[0]; }
+  int values[64];
+};
+
+void test()
+{
+    boost::inplace_function<int(), 16> f;
+    f.assign(large(), std::allocator<int>());
+}
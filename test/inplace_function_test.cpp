@@ -0,0 +1,93 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/ref.hpp>
+#include <memory>
+
+// Whether the target of f is stored in f itself rather than on the heap
+template<typename Function, typename Functor>
+static bool stored_inline(const Function& f, const Functor*)
+{
+  const char* target = reinterpret_cast<const char*>(f.template target<Functor>());
+  const char* self = reinterpret_cast<const char*>(&f);
+  return target >= self && target < self + sizeof(f);
+}
+
+template<int Words>
+struct capture
+{
+  explicit capture(long v)
+  {
+    for (int i = 0; i < Words; ++i)
+      values[i] = v;
+  }
+
+  long operator()(long x) const { return values[0] + values[Words - 1] + x; }
+
+  long values[Words];
+};
+
+struct point
+{
+  point(): x(0) {}
+  long get(long y) const { return x + y; }
+  long x;
+};
+
+static long twice(long x) { return 2 * x; }
+
+int main()
+{
+  typedef boost::inplace_function<long(long), 4 * sizeof(long)> func;
+
+  {
+    func f = capture<4>(1);
+    func g(f);
+    func h;
+    h = g;
+    BOOST_TEST_EQ(f(1), 3);
+    BOOST_TEST_EQ(h(1), 3);
+    BOOST_TEST(h.target<capture<4> >() != 0);
+    BOOST_TEST(stored_inline(f, static_cast<capture<4>*>(0)));
+    BOOST_TEST(stored_inline(g, static_cast<capture<4>*>(0)));
+    BOOST_TEST(stored_inline(h, static_cast<capture<4>*>(0)));
+
+    h = capture<2>(2);
+    BOOST_TEST_EQ(h(0), 4);
+    BOOST_TEST(stored_inline(h, static_cast<capture<2>*>(0)));
+
+    h = &twice;
+    BOOST_TEST_EQ(h(3), 6);
+
+    capture<8> large(3);
+    h = boost::cref(large);
+    BOOST_TEST_EQ(h(0), 6);
+
+    swap(f, h);
+    BOOST_TEST_EQ(f(0), 6);
+    BOOST_TEST_EQ(h(0), 2);
+    BOOST_TEST(stored_inline(h, static_cast<capture<4>*>(0)));
+
+    h.assign(capture<3>(1), std::allocator<int>());
+    BOOST_TEST_EQ(h(1), 3);
+    BOOST_TEST(stored_inline(h, static_cast<capture<3>*>(0)));
+
+    h = 0;
+    BOOST_TEST(h.empty());
+  }
+
+  {
+    boost::inplace_function<long(const point*, long), 2 * sizeof(void*)> m = &point::get;
+    point p;
+    p.x = 5;
+    BOOST_TEST_EQ(m(&p, 1), 6);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,89 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <memory>
+
+static int calls = 0;
+
+struct is_positive
+{
+  bool operator()(int x) const { ++calls; return x > 0; }
+};
+
+struct in_range
+{
+  bool operator()(int x) const { ++calls; return x >= low && x < high; }
+  int low;
+  int high;
+};
+
+struct is_even
+{
+  bool operator()(int x) const { ++calls; return x % 2 == 0; }
+};
+
+static bool is_zero(int x) { ++calls; return x == 0; }
+
+static int total = 0;
+
+struct accumulate
+{
+  void operator()(int x) const { total += x; }
+};
+
+int main()
+{
+  typedef boost::function<bool (int)> predicate;
+
+  in_range r = { 1, 10 };
+  predicate p1 = is_positive();
+  predicate p2 = r;
+  predicate p3 = is_even();
+  predicate p4 = &is_zero;
+
+  // Hits on any of the listed types
+  BOOST_TEST(p1.invoke_as<is_positive>(3));
+  BOOST_TEST((!p1.invoke_as<in_range, is_positive>(-3)));
+  BOOST_TEST((p2.invoke_as<is_positive, in_range>(5)));
+  BOOST_TEST((!p2.invoke_as<is_positive, is_even, in_range>(10)));
+  BOOST_TEST(p4.invoke_as<bool (*)(int)>(0));
+
+  // Misses fall back to the vtable
+  BOOST_TEST(p3.invoke_as<is_positive>(4));
+  BOOST_TEST((!p3.invoke_as<is_positive, in_range>(3)));
+  BOOST_TEST((!p4.invoke_as<is_positive, in_range, is_even>(1)));
+  BOOST_TEST_EQ(calls, 8);
+
+  // Targets assigned with an allocator are called through the vtable
+  {
+    predicate p;
+    p.assign(is_positive(), std::allocator<int>());
+    BOOST_TEST(p.invoke_as<is_positive>(1));
+    BOOST_TEST_EQ(calls, 9);
+  }
+
+  // Empty functions still throw
+  {
+    predicate p;
+    BOOST_TEST_THROWS(p.invoke_as<is_positive>(1), boost::bad_function_call);
+  }
+
+  // Results are converted like with operator()
+  {
+    boost::function<void (int)> f = accumulate();
+    f.invoke_as<accumulate>(2);
+    f.invoke_as<is_positive>(3);
+    BOOST_TEST_EQ(total, 5);
+
+    boost::function1<long, int> g = is_positive();
+    BOOST_TEST_EQ(g.invoke_as<is_positive>(1), 1L);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,161 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+#ifdef BOOST_FUNCTION_HAS_MEMORY_RESOURCE
+
+#include <cstddef>
+#include <memory_resource>
+
+// Counts the blocks it allocates with new and delete
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+  counting_resource() : allocations(0), outstanding(0) {}
+
+  int allocations;
+  int outstanding;
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment)
+  {
+    ++allocations;
+    ++outstanding;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+  {
+    --outstanding;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept
+  {
+    return this == &other;
+  }
+};
+
+// Too large for the small-object buffer
+struct large
+{
+  int operator()(int x) const { return x + value; }
+
+  int value;
+  long padding[8];
+};
+
+struct small
+{
+  int operator()(int x) const { return x * value; }
+
+  int value;
+};
+
+struct move_only_large
+{
+  move_only_large(int v) : value(v) {}
+  move_only_large(move_only_large&&) = default;
+  move_only_large(const move_only_large&) = delete;
+
+  int operator()(int x) const { return x - value; }
+
+  int value;
+  long padding[8];
+};
+
+int main()
+{
+  // Copies allocate from the resource of the function they copy
+  {
+    counting_resource resource;
+    {
+      boost::function<int (int)> f(large{ 1, {} }, &resource);
+      BOOST_TEST_EQ(resource.allocations, 1);
+      BOOST_TEST_EQ(f(2), 3);
+
+      boost::function<int (int)> g(f);
+      BOOST_TEST_EQ(resource.allocations, 2);
+      BOOST_TEST_EQ(g(3), 4);
+
+      boost::function<int (int)> h;
+      h = g;
+      BOOST_TEST_EQ(resource.allocations, 3);
+
+      boost::function<int (int)> moved(std::move(h));
+      BOOST_TEST_EQ(resource.allocations, 3);
+      BOOST_TEST_EQ(moved(4), 5);
+      BOOST_TEST(moved.target<large>() != 0);
+      BOOST_TEST_EQ(resource.outstanding, 3);
+    }
+    BOOST_TEST_EQ(resource.outstanding, 0);
+  }
+
+  // assign(), derived resources, small function objects
+  {
+    counting_resource resource;
+    boost::function<int (int)> f;
+    f.assign(large{ 5, {} }, &resource);
+    BOOST_TEST_EQ(resource.allocations, 1);
+    BOOST_TEST_EQ(f(1), 6);
+
+    f.assign(small{ 3 }, &resource);
+    BOOST_TEST_EQ(resource.outstanding, 0);
+    BOOST_TEST_EQ(f(2), 6);
+    boost::function<int (int)> g(f);
+    BOOST_TEST_EQ(resource.allocations, 1);
+
+    char buffer[1024];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), &resource);
+    boost::function<int (int)> a(large{ 7, {} }, &arena);
+    boost::function<int (int)> b(a);
+    BOOST_TEST_EQ(b(1), 8);
+    BOOST_TEST_EQ(resource.allocations, 1);
+
+    boost::function1<int, int> n(large{ 2, {} }, &resource);
+    BOOST_TEST_EQ(n(2), 4);
+    BOOST_TEST_EQ(resource.allocations, 2);
+  }
+
+  // A null resource stands for the default resource
+  {
+    counting_resource resource;
+    std::pmr::memory_resource* previous = std::pmr::set_default_resource(&resource);
+    {
+      boost::function<int (int)> f(large{ 1, {} }, static_cast<std::pmr::memory_resource*>(0));
+      BOOST_TEST_EQ(resource.allocations, 1);
+    }
+    std::pmr::set_default_resource(previous);
+    BOOST_TEST_EQ(resource.outstanding, 0);
+  }
+
+  // Move-only functions
+  {
+    counting_resource resource;
+    {
+      boost::unique_function<int (int)> f(move_only_large(1), &resource);
+      BOOST_TEST_EQ(resource.allocations, 1);
+      boost::unique_function<int (int)> g(std::move(f));
+      BOOST_TEST_EQ(g(3), 2);
+      BOOST_TEST_EQ(resource.allocations, 1);
+    }
+    BOOST_TEST_EQ(resource.outstanding, 0);
+  }
+
+  return boost::report_errors();
+}
+
+#else
+
+int main()
+{
+  return 0;
+}
+
+#endif
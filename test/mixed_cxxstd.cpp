@@ -40,3 +40,35 @@ EXPORT void call_fn_6( boost::function2<void, int, int> const & fn )
 {
     fn( 1, 2 );
 }
+
+// A function object that C++03 stores inline, and that C++11 stores on the
+// heap because its copy constructor is not noexcept
+struct counter
+{
+    explicit counter( int x ): v( x ) {}
+    counter( counter const & other ): v( other.v ) {}
+
+    int operator()() const
+    {
+        return v;
+    }
+
+    int v;
+};
+
+EXPORT boost::function<int()> make_fn_7( int v )
+{
+    return counter( v );
+}
+
+EXPORT int call_fn_7( boost::function<int()> const & fn )
+{
+    boost::function<int()> fn2( counter( 1 ) );
+    return fn() + fn2();
+}
+
+EXPORT int target_fn_7( boost::function<int()> const & fn )
+{
+    counter const * p = fn.target<counter>();
+    return p? p->v: -1;
+}
@@ -42,6 +42,35 @@ struct MaybeThrowOnCopy {
 
 bool MaybeThrowOnCopy::throwOnCopy = false;
 
+// Trivially copyable and small enough to be stored inline
+struct Four {
+  int operator()() { return 4; }
+};
+
+static int three() { return 3; }
+
+// Stored inline, copyable only through its constructor, and declared
+// trivially relocatable so that moves and swaps never call it
+struct Relocatable {
+  explicit Relocatable(int value) : value(value) { ++live; }
+  Relocatable(const Relocatable& other) BOOST_NOEXCEPT : value(other.value) { ++live; ++copies; }
+  ~Relocatable() { --live; }
+
+  int operator()() { return value; }
+
+  int value;
+
+  static int live;
+  static int copies;
+};
+
+int Relocatable::live = 0;
+int Relocatable::copies = 0;
+
+namespace boost {
+  template<> struct is_trivially_relocatable<Relocatable> : true_type { };
+}
+
 int main()
 {
   boost::function0<int> f;
@@ -57,6 +86,69 @@ int main()
   f.swap(g);
   BOOST_CHECK(f() == 2);
   BOOST_CHECK(g() == 1);
-  
+
+  // Trivially copyable targets, heap targets and empty functions swap
+  // their buffers directly
+  {
+    boost::function0<int> h = &three;
+    boost::function0<int> e;
+    h.swap(e);
+    BOOST_CHECK(h.empty());
+    BOOST_CHECK(e() == 3);
+
+    h = Four();
+    swap(h, e);
+    BOOST_CHECK(h() == 3);
+    BOOST_CHECK(e() == 4);
+
+    e.swap(f);
+    BOOST_CHECK(e() == 2);
+    BOOST_CHECK(f() == 4);
+  }
+
+  // Trivially relocatable targets are swapped and moved without being
+  // copied, and are destroyed exactly once
+  {
+    boost::function0<int> h = Relocatable(5);
+    boost::function0<int> e = &three;
+    Relocatable::copies = 0;
+    BOOST_CHECK(Relocatable::live == 1);
+
+    h.swap(e);
+    swap(e, f);
+    BOOST_CHECK(e() == 4);
+    BOOST_CHECK(f() == 5);
+    BOOST_CHECK(h() == 3);
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    boost::function0<int> m(static_cast<boost::function0<int>&&>(f));
+    BOOST_CHECK(f.empty());
+    BOOST_CHECK(m() == 5);
+    h = static_cast<boost::function0<int>&&>(m);
+    BOOST_CHECK(h() == 5);
+#else
+    swap(h, f);
+    BOOST_CHECK(h() == 5);
+#endif
+
+    BOOST_CHECK(Relocatable::copies == 0);
+    BOOST_CHECK(Relocatable::live == 1);
+
+    // Copies still go through the copy constructor
+    boost::function0<int> c = h;
+    BOOST_CHECK(Relocatable::copies == 1);
+    BOOST_CHECK(Relocatable::live == 2);
+  }
+  BOOST_CHECK(Relocatable::live == 0);
+
+#ifndef BOOST_NO_CXX11_NOEXCEPT
+  {
+    boost::function0<int> h;
+    BOOST_CHECK(noexcept(h.swap(g)));
+    BOOST_CHECK(noexcept(swap(h, g)));
+    BOOST_CHECK(noexcept(h = static_cast<boost::function0<int>&&>(g)));
+  }
+#endif
+
   return boost::report_errors();
 }
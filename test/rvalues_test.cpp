@@ -62,6 +62,111 @@ struct sum_struct {
 #ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
 int three(std::string&&) { return 1; }
 std::string&& four(std::string&& s) { return boost::move(s); }
+
+// Counts how often a function object is copied and moved on its way
+// into a boost::function. Size selects the small buffer or the heap.
+template<int Size>
+struct counted {
+    counted() {}
+    counted(const counted&) { ++copies; }
+    counted(counted&&) BOOST_NOEXCEPT { ++moves; }
+    int operator()(int x) const { return x + Size; }
+
+    static void reset() { copies = moves = 0; }
+
+    char padding[Size];
+    static int copies;
+    static int moves;
+};
+
+template<int Size> int counted<Size>::copies = 0;
+template<int Size> int counted<Size>::moves = 0;
+
+template<int Size>
+void test_forwarding()
+{
+    typedef counted<Size> functor;
+    using boost::function;
+
+    functor::reset();
+    function<int(int)> f1 = functor();
+    BOOST_CHECK(f1(1) == Size + 1);
+    BOOST_CHECK(functor::copies == 0);
+    BOOST_CHECK(functor::moves == 1);
+
+    functor g;
+    functor::reset();
+    function<int(int)> f2 = g;
+    BOOST_CHECK(functor::copies == 1);
+    BOOST_CHECK(functor::moves == 0);
+
+    functor::reset();
+    function<int(int)> f3((functor()), std::allocator<int>());
+    BOOST_CHECK(f3(2) == Size + 2);
+    BOOST_CHECK(functor::copies == 0);
+    BOOST_CHECK(functor::moves == 1);
+
+    functor::reset();
+    boost::function1<int, int> f4;
+    f4 = functor();
+    BOOST_CHECK(functor::copies == 0);
+    BOOST_CHECK(functor::moves == 1);
+
+    functor::reset();
+    f4.assign(functor(), std::allocator<int>());
+    BOOST_CHECK(functor::copies == 0);
+    BOOST_CHECK(functor::moves == 1);
+
+    // Copying a non-const function copies its target rather than
+    // wrapping the function itself
+    functor::reset();
+    function<int(int)> f5(f1);
+    BOOST_CHECK(functor::copies == 1);
+    BOOST_CHECK(f5.target<functor>() != 0);
+}
+
+// Small, but may throw when moved
+struct throwing_move {
+    throwing_move() {}
+    throwing_move(const throwing_move&) {}
+    throwing_move(throwing_move&&) {}
+    int operator()(int x) const { return x; }
+};
+
+template<typename F>
+bool stored_inline(const F& f)
+{
+    const char* p = reinterpret_cast<const char*>(f.template target<throwing_move>());
+    if (!p)
+        p = reinterpret_cast<const char*>(f.template target<counted<1> >());
+    const char* begin = reinterpret_cast<const char*>(&f);
+    return p >= begin && p < begin + sizeof(f);
+}
+
+void test_move()
+{
+    using boost::function;
+
+    BOOST_CHECK((boost::is_nothrow_move_constructible<function<int(int)> >::value));
+    BOOST_CHECK((boost::is_nothrow_move_constructible<boost::function1<int, int> >::value));
+
+    // Moving a function moves a small target instead of copying it
+    function<int(int)> f1 = counted<1>();
+    BOOST_CHECK(stored_inline(f1));
+    counted<1>::reset();
+    function<int(int)> f2(static_cast<function<int(int)>&&>(f1));
+    BOOST_CHECK(f1.empty());
+    BOOST_CHECK(f2(1) == 2);
+    BOOST_CHECK(counted<1>::copies == 0);
+    BOOST_CHECK(counted<1>::moves == 1);
+
+    // Function objects whose move may throw are kept on the heap
+    function<int(int)> f3 = throwing_move();
+    BOOST_CHECK(!stored_inline(f3));
+    function<int(int)> f4(static_cast<function<int(int)>&&>(f3));
+    BOOST_CHECK(f3.empty());
+    BOOST_CHECK(f4(3) == 3);
+}
 #endif
 
 int main()
@@ -101,6 +206,22 @@ int main()
 
     f3(std::string("Hello"));
     BOOST_CHECK(f4(std::string("world")) == "world");
+
+    test_forwarding<1>();
+    test_forwarding<100>();
+    test_move();
+
+    {
+        // Assignment to a heap-stored target moves it once and then
+        // transfers ownership
+        typedef counted<100> functor;
+        function<int(int)> f;
+        functor::reset();
+        f = functor();
+        BOOST_CHECK(f(0) == 100);
+        BOOST_CHECK(functor::copies == 0);
+        BOOST_CHECK(functor::moves == 1);
+    }
 #endif
 
     return boost::report_errors();
@@ -0,0 +1,153 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/ref.hpp>
+#include <memory>
+
+static int twice(int x) { return 2 * x; }
+static int thrice(int x) { return 3 * x; }
+
+struct add
+{
+  explicit add(int v): value(v) {}
+  int operator()(int x) const { return value + x; }
+  int value;
+};
+
+bool operator==(const add& x, const add& y) { return x.value == y.value; }
+
+// Stored on the heap
+struct add_large
+{
+  explicit add_large(int v) { values[0] = v; }
+  int operator()(int x) const { return values[0] + x; }
+  int values[64];
+};
+
+struct counter
+{
+  counter(): value(0) {}
+  int increment(int x) { return value += x; }
+  int value;
+};
+
+int main()
+{
+  typedef boost::function<int (int)> func;
+
+  // Function objects and function pointers are found by their identity
+  {
+    func f = add(1);
+    func g = add_large(2);
+    func h = &twice;
+
+    BOOST_TEST(f.target<add>() != 0);
+    BOOST_TEST_EQ(f.target<add>()->value, 1);
+    BOOST_TEST_EQ(g.target<add_large>()->values[0], 2);
+    BOOST_TEST(*h.target<int (*)(int)>() == &twice);
+
+    BOOST_TEST(f.target<add_large>() == 0);
+    BOOST_TEST(g.target<add>() == 0);
+    BOOST_TEST(h.target<add>() == 0);
+    BOOST_TEST(f.target<int (*)(int)>() == 0);
+
+    // cv-qualifiers may be added
+    const func& cf = f;
+    BOOST_TEST(cf.target<add>() == f.target<add>());
+    BOOST_TEST(f.target<const add>() == f.target<add>());
+    BOOST_TEST(f.target<volatile add>() != 0);
+
+    // Pointers reach the stored target
+    f.target<add>()->value = 5;
+    BOOST_TEST_EQ(f(1), 6);
+
+    BOOST_TEST(f.contains(add(5)));
+    BOOST_TEST(!f.contains(add(1)));
+    BOOST_TEST(h.contains(&twice));
+    BOOST_TEST(!h.contains(&thrice));
+    BOOST_TEST(!h.contains(add(5)));
+
+    // Copies share the identity of their vtable
+    func c = f;
+    BOOST_TEST(c.target<add>() != f.target<add>());
+    BOOST_TEST(c.contains(add(5)));
+  }
+
+  // Other targets are found by comparing their type_info
+  {
+    func f;
+    f.assign(add(3), std::allocator<int>());
+    BOOST_TEST(f.target<add>() != 0);
+    BOOST_TEST_EQ(f.target<add>()->value, 3);
+    BOOST_TEST(f.contains(add(3)));
+
+    func g;
+    g.assign(add_large(4), std::allocator<int>());
+    BOOST_TEST_EQ(g.target<add_large>()->values[0], 4);
+
+    add a(7);
+    func r = boost::ref(a);
+    BOOST_TEST(r.target<add>() == &a);
+    BOOST_TEST(r.contains(a));
+
+    func cr = boost::cref(a);
+    BOOST_TEST(cr.target<add>() == 0);
+    BOOST_TEST(cr.target<const add>() == &a);
+
+    counter c;
+    boost::function<int (counter*, int)> m = &counter::increment;
+    BOOST_TEST(m.target<int (counter::*)(int)>() != 0);
+    BOOST_TEST(m.target<add>() == 0);
+
+    func d = boost::make_delegate(&c, &counter::increment);
+    BOOST_TEST((d.target<boost::delegate<counter, int (counter::*)(int)> >() != 0));
+    BOOST_TEST(d.target<add>() == 0);
+  }
+
+  // target_type() does not depend on RTTI either
+  {
+    func f = add(1);
+    BOOST_TEST(f.target_type() == boost::typeindex::type_id<add>());
+    f = &twice;
+    BOOST_TEST(f.target_type() == boost::typeindex::type_id<int (*)(int)>());
+    f.clear();
+    BOOST_TEST(f.target_type() == boost::typeindex::type_id<void>());
+  }
+
+  // Empty functions have no target
+  {
+    func f;
+    BOOST_TEST(f.target<add>() == 0);
+    BOOST_TEST(f.target<int (*)(int)>() == 0);
+    BOOST_TEST(!f.contains(&twice));
+
+    const boost::function_base& b = f;
+    BOOST_TEST(b.target<add>() == 0);
+  }
+
+  // Through function_base and the other wrappers
+  {
+    func f = add(8);
+    boost::function_base& b = f;
+    BOOST_TEST_EQ(b.target<add>()->value, 8);
+
+    boost::inplace_function<int (int), 16> i = add(9);
+    BOOST_TEST_EQ(i.target<add>()->value, 9);
+    i = &thrice;
+    BOOST_TEST(*i.target<int (*)(int)>() == &thrice);
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    boost::unique_function<int (int)> u = add_large(10);
+    BOOST_TEST_EQ(u.target<add_large>()->values[0], 10);
+    BOOST_TEST(u.target<add>() == 0);
+#endif
+  }
+
+  return boost::report_errors();
+}
@@ -15,6 +15,24 @@ void call_fn_4( boost::function0<void> const & fn );
 void call_fn_5( boost::function1<void, int> const & fn );
 void call_fn_6( boost::function2<void, int, int> const & fn );
 
+// Placed differently by C++03 and C++11; see mixed_cxxstd.cpp
+struct counter
+{
+    explicit counter( int x ): v( x ) {}
+    counter( counter const & other ): v( other.v ) {}
+
+    int operator()() const
+    {
+        return v;
+    }
+
+    int v;
+};
+
+boost::function<int()> make_fn_7( int v );
+int call_fn_7( boost::function<int()> const & fn );
+int target_fn_7( boost::function<int()> const & fn );
+
 //
 
 static int v;
@@ -44,5 +62,22 @@ int main()
     v = 0; call_fn_5( f1 ); BOOST_TEST_EQ( v, 1 );
     v = 0; call_fn_6( f2 ); BOOST_TEST_EQ( v, 3 );
 
+    {
+        boost::function<int()> fn( counter( 2 ) );
+        BOOST_TEST_EQ( fn(), 2 );
+        BOOST_TEST_EQ( call_fn_7( fn ), 3 );
+        BOOST_TEST_EQ( target_fn_7( fn ), 2 );
+
+        boost::function<int()> fn2 = make_fn_7( 4 );
+        BOOST_TEST_EQ( fn2(), 4 );
+        BOOST_TEST( fn2.target<counter>() != 0 );
+        BOOST_TEST_EQ( fn2.target<counter>()->v, 4 );
+
+        fn = fn2;
+        fn2 = counter( 5 );
+        BOOST_TEST_EQ( fn(), 4 );
+        BOOST_TEST_EQ( fn2(), 5 );
+    }
+
     return boost::report_errors();
 }
@@ -0,0 +1,142 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+
+#include <memory>
+
+static int live = 0;
+
+// A move-only function object owning Words values
+template<int Words>
+struct owner
+{
+  explicit owner(int v): value(new int(v)) { ++live; }
+  owner(owner&& other) BOOST_NOEXCEPT: value(other.value) { other.value = 0; }
+  ~owner() { if (value) { delete value; --live; } }
+
+  int operator()(int x) const { return *value + x; }
+
+  int* value;
+  int padding[Words];
+
+private:
+  owner(const owner&);
+  owner& operator=(const owner&);
+};
+
+struct add_to
+{
+  explicit add_to(int v): p(new int(v)) {}
+  int operator()(int x) const { return *p + x; }
+  std::unique_ptr<int> p;
+};
+
+int twice(int x) { return 2 * x; }
+
+int main()
+{
+  typedef boost::unique_function<int(int)> func;
+
+  BOOST_TEST((boost::is_nothrow_move_constructible<func>::value));
+
+  // Small and large move-only targets
+  {
+    func f = owner<1>(1);
+    func g = owner<100>(2);
+    BOOST_TEST_EQ(f(1), 2);
+    BOOST_TEST_EQ(g(1), 3);
+    BOOST_TEST_EQ(live, 2);
+
+    func h(static_cast<func&&>(f));
+    BOOST_TEST(f.empty());
+    BOOST_TEST_EQ(h(2), 3);
+
+    h = static_cast<func&&>(g);
+    BOOST_TEST(!g);
+    BOOST_TEST_EQ(h(2), 4);
+    BOOST_TEST_EQ(live, 1);
+  }
+  BOOST_TEST_EQ(live, 0);
+
+  // Members holding unique_ptr, function pointers and copyable targets
+  {
+    func f = add_to(3);
+    BOOST_TEST_EQ(f(1), 4);
+    BOOST_TEST(f.target<add_to>() != 0);
+    BOOST_TEST(f.target_type() == boost::typeindex::type_id<add_to>());
+
+    f = &twice;
+    BOOST_TEST_EQ(f(4), 8);
+    BOOST_TEST(f.contains(&twice));
+
+    f = boost::function<int(int)>(&twice);
+    BOOST_TEST_EQ(f(5), 10);
+
+    f = 0;
+    BOOST_TEST(f == 0);
+    BOOST_TEST_THROWS(f(0), boost::bad_function_call);
+  }
+
+  // Allocator support
+  {
+    func f(owner<1>(4), std::allocator<int>());
+    func g;
+    g.assign(owner<100>(5), std::allocator<int>());
+    BOOST_TEST_EQ(f(0), 4);
+    BOOST_TEST_EQ(g(0), 5);
+
+    swap(f, g);
+    BOOST_TEST_EQ(f(0), 5);
+    BOOST_TEST_EQ(g(0), 4);
+
+    func h(static_cast<func&&>(f));
+    BOOST_TEST_EQ(h(0), 5);
+  }
+  BOOST_TEST_EQ(live, 0);
+
+  // Portable syntax
+  {
+    boost::unique_function1<int, int> f = owner<2>(6);
+    boost::unique_function1<int, int> g;
+    f.swap(g);
+    BOOST_TEST(f.empty());
+    BOOST_TEST_EQ(g(0), 6);
+    g.clear();
+    BOOST_TEST(g.empty());
+  }
+  BOOST_TEST_EQ(live, 0);
+
+  // Calls through a guessed target type, and swaps of trivially
+  // relocatable targets
+  {
+    func f = add_to(7);
+    func g = &twice;
+    BOOST_TEST_EQ((f.invoke_as<add_to>(1)), 8);
+    BOOST_TEST_EQ((f.invoke_as<int (*)(int), add_to>(1)), 8);
+    BOOST_TEST_EQ((g.invoke_as<add_to>(3)), 6);
+
+    swap(f, g);
+    BOOST_TEST_EQ(f(3), 6);
+    BOOST_TEST_EQ(g(1), 8);
+    BOOST_TEST(f.contains(&twice));
+  }
+
+  return boost::report_errors();
+}
+
+#else
+
+int main()
+{
+  return 0;
+}
+
+#endif
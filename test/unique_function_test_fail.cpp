@@ -0,0 +1,16 @@
+// Boost.Function library
+
+// Use, modification and distribution is subject to the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// For more information, see http://www.boost.org
+
+#include <boost/function.hpp>
+
+int one() { return 1; }
+
+void test()
+{
+    boost::unique_function<int()> f1 = &one;
+    boost::unique_function<int()> f2(f1);
+}